@@ -0,0 +1,89 @@
+#include <Arduino.h>
+
+#include <stdarg.h>
+
+static uint64_t mockTime = 0;
+
+HardwareSerial Serial;
+
+unsigned long millis() {
+    return (uint32_t) (mockTime / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t) mockTime;
+}
+
+void delay(unsigned long ms) {
+    mockTime += (uint64_t) ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    mockTime += us;
+}
+
+void yield() {
+}
+
+void mockSetMicros(uint64_t time) {
+    mockTime = time;
+}
+
+void mockAdvanceMicros(uint64_t duration) {
+    mockTime += duration;
+}
+
+uint64_t mockMicros() {
+    return mockTime;
+}
+
+void configTime(const char* tz, const char* server1, const char* server2, const char* server3) {
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (size-- > 0) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::print(const char* text) {
+    return write((const uint8_t*) text, strlen(text));
+}
+
+size_t Print::print(long number) {
+    char text[24];
+    sprintf(text, "%ld", number);
+    return print(text);
+}
+
+size_t Print::println(const char* text) {
+    return print(text) + println();
+}
+
+size_t Print::println(long number) {
+    return print(number) + println();
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+size_t Print::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return print(text);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!started) {
+        return 1;
+    }
+    return fwrite(&c, 1, 1, stdout);
+}
@@ -0,0 +1,90 @@
+#ifndef __ARDUINO_MOCK_H
+#define __ARDUINO_MOCK_H
+
+/**
+ The parts of the Arduino core used by the project, for builds on the host
+ (see [env:native] in platformio.ini). Time is simulated: it starts at 0 and
+ only advances through delay() and the 'mock*' functions, so tests run
+ independent of the speed of the host.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+/* Data in flash is plain memory on the host */
+#define PROGMEM
+#define memcpy_P memcpy
+#define pgm_read_byte(address)  (*(const uint8_t*) (address))
+#define pgm_read_word(address)  (*(const uint16_t*) (address))
+#define pgm_read_dword(address) (*(const uint32_t*) (address))
+
+/* There are no pins, writes are ignored */
+#define LOW    0
+#define HIGH   1
+#define INPUT  0
+#define OUTPUT 1
+
+static inline void pinMode(uint8_t pin, uint8_t mode) { }
+static inline void digitalWrite(uint8_t pin, uint8_t value) { }
+
+/* The simulated clock, the frequency of the ESP8266 is used for cycles */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+static inline uint32_t clockCyclesPerMicrosecond() {
+    return 80;
+}
+
+/* Set the simulated time (in µs), micros() and millis() overflow like on the target */
+void mockSetMicros(uint64_t time);
+
+/* Advance the simulated time, e.g. to simulate the runtime of a task */
+void mockAdvanceMicros(uint64_t duration);
+
+/* The simulated time (in µs), without overflow */
+uint64_t mockMicros();
+
+/* Set the time zone, the NTP servers are ignored */
+void configTime(const char* tz, const char* server1, const char* server2 = nullptr, const char* server3 = nullptr);
+
+class Print {
+public:
+    virtual ~Print() { }
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const char* text);
+    size_t print(long number);
+    size_t println(const char* text);
+    size_t println(long number);
+    size_t println();
+    size_t printf(const char* format, ...);
+};
+
+/* Writes to stdout once 'begin()' was called, so tests stay quiet */
+class HardwareSerial : public Print {
+    bool started = false;
+public:
+    void begin(unsigned long baud) {
+        started = true;
+    }
+    virtual size_t write(uint8_t c);
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef __EEPROM_MOCK_H
+#define __EEPROM_MOCK_H
+
+#include <Arduino.h>
+
+/* The emulated EEPROM of the ESP8266, kept in RAM (erased flash reads as 0xFF) */
+class EEPROMClass {
+    uint8_t data[4096];
+    size_t size = 0;
+    uint32_t commits = 0;
+public:
+    EEPROMClass() {
+        memset(data, 0xFF, sizeof(data));
+    }
+    void begin(size_t bytes) {
+        size = min(bytes, sizeof(data));
+    }
+    uint8_t read(int address) {
+        return (address >= 0 && (size_t) address < size) ? data[address] : 0;
+    }
+    void write(int address, uint8_t value) {
+        if (address >= 0 && (size_t) address < size) {
+            data[address] = value;
+        }
+    }
+    bool commit() {
+        commits += 1;
+        return size > 0;
+    }
+    /* The number of calls to 'commit()', which block the loop on the target */
+    uint32_t getCommits() {
+        return commits;
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -38,13 +38,13 @@ CLEDController &CFastLED::addLeds(CLEDController *pLed,
 
 	pLed->init();
 	pLed->setLeds(data + nOffset, nLeds);
-	FastLED.setMaxRefreshRate(pLed->getMaxRefreshRate(),true);
+	// The refresh rate of each controller is limited separately, see CLEDController::isReadyToShow()
 	return *pLed;
 }
 
-void CFastLED::show(uint8_t scale) {
+bool CFastLED::show(uint8_t scale) {
 	// guard against showing too rapidly
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
+	if(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros)) { return false; }
 	lastshow = micros();
 
 	// If we have a function for computing power, use it!
@@ -52,15 +52,29 @@ void CFastLED::show(uint8_t scale) {
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
 	}
 
+	// Dithering flickers at low frame rates
+	bool noDither = (m_nFPS < 100);
+	bool shown = true;
+	bool sent = false;
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-		uint8_t d = pCur->getDither();
-		if(m_nFPS < 100) { pCur->setDither(0); }
-		pCur->showLeds(scale);
-		pCur->setDither(d);
+		// Controllers not ready yet are left for the next call
+		if(!pCur->isReadyToShow()) {
+			shown = false;
+		} else if(noDither) {
+			uint8_t d = pCur->getDither();
+			pCur->setDither(0);
+			pCur->showLeds(scale);
+			pCur->setDither(d);
+			sent = true;
+		} else {
+			pCur->showLeds(scale);
+			sent = true;
+		}
 		pCur = pCur->next();
 	}
-	countFPS();
+	if(sent) { countFPS(); }
+	return shown;
 }
 
 int CFastLED::count() {
@@ -85,8 +99,9 @@ CLEDController & CFastLED::operator[](int x) {
 	}
 }
 
-void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
-	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
+bool CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
+	// guard against showing too rapidly
+	if(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros)) { return false; }
 	lastshow = micros();
 
 	// If we have a function for computing power, use it!
@@ -94,20 +109,43 @@ void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
 	}
 
+	// Dithering flickers at low frame rates
+	bool noDither = (m_nFPS < 100);
+	bool shown = true;
+	bool sent = false;
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-		uint8_t d = pCur->getDither();
-		if(m_nFPS < 100) { pCur->setDither(0); }
-		pCur->showColor(color, scale);
-		pCur->setDither(d);
+		// Controllers not ready yet are left for the next call
+		if(!pCur->isReadyToShow()) {
+			shown = false;
+		} else if(noDither) {
+			uint8_t d = pCur->getDither();
+			pCur->setDither(0);
+			pCur->showColor(color, scale);
+			pCur->setDither(d);
+			sent = true;
+		} else {
+			pCur->showColor(color, scale);
+			sent = true;
+		}
 		pCur = pCur->next();
 	}
-	countFPS();
+	if(sent) { countFPS(); }
+	return shown;
 }
 
 void CFastLED::clear(boolean writeData) {
 	if(writeData) {
-		showColor(CRGB(0,0,0), 0);
+		// Black out each controller once, as soon as its refresh rate allows
+		CLEDController *pCur = CLEDController::head();
+		while(pCur) {
+			if(!pCur->isReadyToShow()) {
+				delayMicroseconds(pCur->getNextShowMicros() - micros());
+			}
+			pCur->showColor(CRGB(0,0,0), 0);
+			pCur = pCur->next();
+		}
+		countFPS();
 	}
     clearData();
 }
@@ -232,7 +270,9 @@ void CFastLED::setMaxRefreshRate(uint16_t refresh, bool constrain) {
   }
 }
 
+#ifndef FASTLED_HOST
 extern "C" int atexit(void (* /*func*/ )()) { return 0; }
+#endif
 
 #ifdef NEED_CXX_BITS
 namespace __cxxabiv1
@@ -468,15 +468,19 @@ public:
 	/// @param milliwatts - the max power draw desired, in milliwatts
 	inline void setMaxPowerInMilliWatts(uint32_t milliwatts) { m_pPowerFunc = &calculate_max_brightness_for_power_mW; m_nPowerData = milliwatts; }
 
-	/// Update all our controllers with the current led colors, using the passed in brightness
+	/// Update all our controllers with the current led colors, using the passed in brightness.
+	/// Doesn't wait for controllers which can't be shown yet because of their maximum refresh rate
 	/// @param scale temporarily override the scale
-	void show(uint8_t scale);
+	/// @returns false if at least one controller was not ready, call again later to show it
+	bool show(uint8_t scale);
 
 	/// Update all our controllers with the current led colors
-	void show() { show(m_Scale); }
+	/// @returns false if at least one controller was not ready, call again later to show it
+	bool show() { return show(m_Scale); }
 
 	/// clear the leds, wiping the local array of data, optionally black out the leds as well
-	/// @param writeData whether or not to write out to the leds as well
+	/// @param writeData whether or not to write out to the leds as well, waiting until each
+	/// controller is ready (see CLEDController::isReadyToShow())
 	void clear(boolean writeData = false);
 
 	/// clear out the local data array
@@ -485,11 +489,13 @@ public:
 	/// Set all leds on all controllers to the given color/scale
 	/// @param color what color to set the leds to
 	/// @param scale what brightness scale to show at
-	void showColor(const struct CRGB & color, uint8_t scale);
+	/// @returns false if at least one controller was not ready, call again later to show it
+	bool showColor(const struct CRGB & color, uint8_t scale);
 
 	/// Set all leds on all controllers to the given color
 	/// @param color what color to set the leds to
-	void showColor(const struct CRGB & color) { showColor(color, m_Scale); }
+	/// @returns false if at least one controller was not ready, call again later to show it
+	bool showColor(const struct CRGB & color) { return showColor(color, m_Scale); }
 
 	/// Delay for the given number of milliseconds.  Provided to allow the library to be used on platforms
 	/// that don't have a delay function (to allow code to be more portable).  Note: this will call show
@@ -513,10 +519,9 @@ public:
 	void setDither(uint8_t ditherMode = BINARY_DITHER);
 
 	/// Set the maximum refresh rate.  This is global for all leds.  Attempts to
-	/// call show faster than this rate will simply wait.  Note that the refresh rate
-	/// defaults to the slowest refresh rate of all the leds added through addLeds.  If
-	/// you wish to set/override this rate, be sure to call setMaxRefreshRate _after_
-	/// adding all of your leds.
+	/// call show faster than this rate return false without showing anything.  Each
+	/// controller is limited to its own getMaxRefreshRate() in addition, see
+	/// CLEDController::getNextShowMicros().
 	/// @param refresh - maximum refresh rate in hz
 	/// @param constrain - constrain refresh rate to the slowest speed yet set
 	void setMaxRefreshRate(uint16_t refresh, bool constrain=false);
@@ -24,6 +24,19 @@ FASTLED_NAMESPACE_BEGIN
 #define BINARY_DITHER 0x01
 typedef uint8_t EDitherMode;
 
+/// Statistics of the frames sent by a controller
+struct FrameStats {
+    /// frames sent completely
+    uint32_t frames;
+    /// attempts interrupted for too long, and started again
+    uint32_t retries;
+    /// frames given up after FASTLED_INTERRUPT_RETRY_COUNT retries
+    uint32_t aborts;
+    /// shortest and longest time to show a frame, including retries (in cpu cycles)
+    uint32_t minCycles;
+    uint32_t maxCycles;
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // LED Controller interface definition
@@ -44,6 +57,17 @@ protected:
     CRGB m_ColorTemperature;
     EDitherMode m_DitherMode;
     int m_nLeds;
+    bool m_SkipIdentical;
+    uint32_t m_FrameHash;
+    uint32_t m_LastFrameMillis;
+    uint32_t m_RefreshMillis;
+    uint32_t m_SkippedFrames;
+    FrameStats m_FrameStats;
+    CRGB m_Adjustment;
+    uint8_t m_AdjustmentScale;
+    bool m_AdjustmentValid;
+    uint32_t m_nLastShowMicros;
+    uint32_t m_nShowInterval;
     static CLEDController *m_pHead;
     static CLEDController *m_pTail;
 
@@ -59,9 +83,52 @@ protected:
 	///@param scale the rgb scaling to apply to each led before writing it out
     virtual void show(const struct CRGB *data, int nLeds, CRGB scale) = 0;
 
+    /// check if a frame is identical to the last transmitted frame, and can be skipped.  The
+    /// frame is identified by a hash of the led data, the number of leds, the scale and the dithering
+    ///@param data the rgb data of the frame, or a single color
+    ///@param nBytes the number of bytes of rgb data
+    ///@param nLeds the number of leds being written out
+    ///@param scale the rgb scaling applied to each led
+    bool skipFrame(const uint8_t *data, int nBytes, int nLeds, CRGB scale) {
+        if(!m_SkipIdentical) { return false; }
+        // FNV-1a
+        uint32_t hash = 2166136261UL;
+        for(int i = 0; i < nBytes; i++) { hash = (hash ^ data[i]) * 16777619UL; }
+        hash = (hash ^ scale.r) * 16777619UL;
+        hash = (hash ^ scale.g) * 16777619UL;
+        hash = (hash ^ scale.b) * 16777619UL;
+        hash = (hash ^ m_DitherMode) * 16777619UL;
+        hash = (hash ^ (nLeds & 0xFF)) * 16777619UL;
+        hash = (hash ^ (nLeds >> 8)) * 16777619UL;
+
+        uint32_t now = millis();
+        if(hash == m_FrameHash && (m_RefreshMillis == 0 || (now - m_LastFrameMillis) < m_RefreshMillis)) {
+            m_SkippedFrames++;
+            return true;
+        }
+        m_FrameHash = hash;
+        m_LastFrameMillis = now;
+        return false;
+    }
+
+    /// add a frame to the statistics, to be called by the controllers at the end of showPixels
+    ///@param sent true if the frame was sent, false if it was aborted
+    ///@param retries the number of retries needed for the frame
+    ///@param cycles the time spent showing the frame (in cpu cycles)
+    void recordFrame(bool sent, uint8_t retries, uint32_t cycles) {
+        m_FrameStats.retries += retries;
+        if(!sent) { m_FrameStats.aborts++; return; }
+        m_FrameStats.frames++;
+        if(cycles < m_FrameStats.minCycles) { m_FrameStats.minCycles = cycles; }
+        if(cycles > m_FrameStats.maxCycles) { m_FrameStats.maxCycles = cycles; }
+    }
+
 public:
 	/// create an led controller object, add it to the chain of controllers
-    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0) {
+    CLEDController() : m_Data(NULL), m_ColorCorrection(UncorrectedColor), m_ColorTemperature(UncorrectedTemperature), m_DitherMode(BINARY_DITHER), m_nLeds(0),
+        m_SkipIdentical(false), m_FrameHash(0), m_LastFrameMillis(0), m_RefreshMillis(0), m_SkippedFrames(0),
+        m_AdjustmentScale(0), m_AdjustmentValid(false), m_nLastShowMicros(0), m_nShowInterval(0) {
+        resetFrameStats();
         m_pNext = NULL;
         if(m_pHead==NULL) { m_pHead = this; }
         if(m_pTail != NULL) { m_pTail->m_pNext = this; }
@@ -94,6 +161,21 @@ public:
         showColor(data, m_nLeds, getAdjustment(brightness));
     }
 
+    /// check if the next frame can be shown, without exceeding getMaxRefreshRate().  The show
+    /// functions don't wait, so callers should check this first (as CFastLED::show does)
+    bool isReadyToShow() { return (micros() - m_nLastShowMicros) >= m_nShowInterval; }
+
+    /// get the time (in micros()) from which the next frame can be shown
+    uint32_t getNextShowMicros() { return m_nLastShowMicros + m_nShowInterval; }
+
+    /// remember the time of a frame, to limit the refresh rate.  Called by the controllers when
+    /// a frame is sent, skipped identical frames don't count
+    void markShown() {
+        uint16_t refresh = getMaxRefreshRate();
+        m_nLastShowMicros = micros();
+        m_nShowInterval = (refresh > 0) ? (1000000 / refresh) : 0;
+    }
+
     /// get the first led controller in the chain of controllers
     static CLEDController *head() { return m_pHead; }
     /// get the next controller in the chain after this one.  will return NULL at the end of the chain
@@ -127,23 +209,50 @@ public:
     /// get the dithering option currently set for this controller
     inline uint8_t getDither() { return m_DitherMode; }
 
+    /// skip frames identical to the last transmitted frame.  Note that skipped frames also
+    /// pause the temporal dithering, which keeps its last pattern
+    ///@param skip true to skip identical frames
+    ///@param refreshMillis send identical frames again after this time (0: never), for noise immunity
+    CLEDController & setSkipIdenticalFrames(bool skip = true, uint32_t refreshMillis = 0) {
+        m_SkipIdentical = skip;
+        m_RefreshMillis = refreshMillis;
+        m_FrameHash = 0;
+        return *this;
+    }
+    /// get the number of frames skipped, because they were identical to the last frame
+    uint32_t getSkippedFrames() { return m_SkippedFrames; }
+
+    /// get the statistics of the frames sent by this controller
+    const FrameStats & getFrameStats() { return m_FrameStats; }
+    /// clear the frame statistics
+    void resetFrameStats() {
+        memset(&m_FrameStats, 0, sizeof(FrameStats));
+        m_FrameStats.minCycles = 0xFFFFFFFF;
+    }
+
 	/// the the color corrction to use for this controller, expressed as an rgb object
-    CLEDController & setCorrection(CRGB correction) { m_ColorCorrection = correction; return *this; }
+    CLEDController & setCorrection(CRGB correction) { m_ColorCorrection = correction; m_AdjustmentValid = false; return *this; }
     /// set the color correction to use for this controller
-    CLEDController & setCorrection(LEDColorCorrection correction) { m_ColorCorrection = correction; return *this; }
+    CLEDController & setCorrection(LEDColorCorrection correction) { m_ColorCorrection = correction; m_AdjustmentValid = false; return *this; }
     /// get the correction value used by this controller
     CRGB getCorrection() { return m_ColorCorrection; }
 
 	/// set the color temperature, aka white point, for this controller
-    CLEDController & setTemperature(CRGB temperature) { m_ColorTemperature = temperature; return *this; }
+    CLEDController & setTemperature(CRGB temperature) { m_ColorTemperature = temperature; m_AdjustmentValid = false; return *this; }
     /// set the color temperature, aka white point, for this controller
-    CLEDController & setTemperature(ColorTemperature temperature) { m_ColorTemperature = temperature; return *this; }
+    CLEDController & setTemperature(ColorTemperature temperature) { m_ColorTemperature = temperature; m_AdjustmentValid = false; return *this; }
     /// get the color temperature, aka whipe point, for this controller
     CRGB getTemperature() { return m_ColorTemperature; }
 
-	/// Get the combined brightness/color adjustment for this controller
+	/// Get the combined brightness/color adjustment for this controller.  The last adjustment
+	/// is kept until the brightness, correction or temperature changes
     CRGB getAdjustment(uint8_t scale) {
-        return computeAdjustment(scale, m_ColorCorrection, m_ColorTemperature);
+        if(!m_AdjustmentValid || scale != m_AdjustmentScale) {
+            m_Adjustment = computeAdjustment(scale, m_ColorCorrection, m_ColorTemperature);
+            m_AdjustmentScale = scale;
+            m_AdjustmentValid = true;
+        }
+        return m_Adjustment;
     }
 
     static CRGB computeAdjustment(uint8_t scale, const CRGB & colorCorrection, const CRGB & colorTemperature) {
@@ -383,6 +492,8 @@ protected:
   ///@param nLeds the numner of leds to set to this color
   ///@param scale the rgb scaling value for outputting color
   virtual void showColor(const struct CRGB & data, int nLeds, CRGB scale) {
+    if(skipFrame(data.raw, 3, nLeds, scale)) { return; }
+    markShown();
     PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
     showPixels(pixels);
   }
@@ -392,6 +503,8 @@ protected:
 ///@param nLeds the number of leds being written out
 ///@param scale the rgb scaling to apply to each led before writing it out
   virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
+    if(skipFrame((const uint8_t*)data, nLeds * LANES * 3, nLeds, scale)) { return; }
+    markShown();
     PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
     showPixels(pixels);
   }
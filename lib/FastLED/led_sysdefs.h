@@ -22,6 +22,8 @@
 #include "platforms/arm/d21/led_sysdefs_arm_d21.h"
 #elif defined(ESP8266)
 #include "platforms/esp/8266/led_sysdefs_esp8266.h"
+#elif defined(FASTLED_HOST)
+#include "platforms/host/led_sysdefs_host.h"
 #else
 // AVR platforms
 #include "platforms/avr/led_sysdefs_avr.h"
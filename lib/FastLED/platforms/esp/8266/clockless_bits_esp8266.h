@@ -0,0 +1,27 @@
+#ifndef __INC_CLOCKLESS_BITS_ESP8266_H
+#define __INC_CLOCKLESS_BITS_ESP8266_H
+
+#include <stdint.h>
+
+// The timed loop of the esp8266 ClocklessController, generic over the cycle counter
+// and the data pin, so that the host simulation (clockless_sim_esp8266.h) replays the
+// same code. CLOCK::cycles() reads the cycle counter, PIN::hi() and PIN::lo() set the
+// data line. Writes the BITS most significant bits of the lowest byte of 'b'.
+template<int BITS, int T1, int T2, int T3, class CLOCK, class PIN>
+__attribute__ ((always_inline)) inline static void clocklessWriteBits(uint32_t & last_mark, uint32_t b) {
+	b = ~b; b <<= 24;
+	for(uint32_t i = BITS; i > 0; i--) {
+		while((CLOCK::cycles() - last_mark) < (uint32_t)(T1+T2+T3));
+		last_mark = CLOCK::cycles();
+		PIN::hi();
+
+		while((CLOCK::cycles() - last_mark) < (uint32_t)T1);
+		if(b & 0x80000000L) { PIN::lo(); }
+		b <<= 1;
+
+		while((CLOCK::cycles() - last_mark) < (uint32_t)(T1+T2));
+		PIN::lo();
+	}
+}
+
+#endif
@@ -30,6 +30,7 @@ public:
 	virtual void showPixels(PixelController<RGB_ORDER, LANES, PORT_MASK> & pixels) {
 		// mWait.wait();
 		/*uint32_t clocks = */
+		uint32_t start = __clock_cycles();
 		int cnt=FASTLED_INTERRUPT_RETRY_COUNT;
 		while(!showRGBInternal(pixels) && cnt--) {
       os_intr_unlock();
@@ -39,6 +40,7 @@ public:
       delayMicroseconds(WAIT_TIME * 10);
       os_intr_lock();
     }
+		this->recordFrame(cnt >= 0, FASTLED_INTERRUPT_RETRY_COUNT - (cnt < 0 ? 0 : cnt), __clock_cycles() - start);
 		// #if FASTLED_ALLOW_INTTERUPTS == 0
 		// Adjust the timer
 		// long microsTaken = CLKS_TO_MICROS(clocks);
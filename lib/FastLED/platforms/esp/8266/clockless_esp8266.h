@@ -1,5 +1,7 @@
 #pragma once
 
+#include "clockless_bits_esp8266.h"
+
 FASTLED_NAMESPACE_BEGIN
 
 #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
@@ -16,15 +18,37 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 
 #define FASTLED_HAS_CLOCKLESS 1
 
+// Define FASTLED_ESP8266_PREENCODE to convert each frame into wire order, with scaling
+// and dithering applied, before interrupts are disabled. The timed loop then only
+// shifts out raw bytes, and retries send the same buffer again. Needs 3 bytes of RAM
+// per led, allocated with the first frame.
+
 template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
 class ClocklessController : public CPixelLEDController<RGB_ORDER> {
 	typedef typename FastPin<DATA_PIN>::port_ptr_t data_ptr_t;
 	typedef typename FastPin<DATA_PIN>::port_t data_t;
 
+	// The cycle counter and data pin of clocklessWriteBits
+	struct CycleClock {
+		__attribute__ ((always_inline)) inline static uint32_t cycles() { return __clock_cycles(); }
+	};
+	struct DataPin {
+		__attribute__ ((always_inline)) inline static void hi() { FastPin<DATA_PIN>::hi(); }
+		__attribute__ ((always_inline)) inline static void lo() { FastPin<DATA_PIN>::lo(); }
+	};
+
 	data_t mPinMask;
 	data_ptr_t mPort;
 	CMinWait<WAIT_TIME> mWait;
+#ifdef FASTLED_ESP8266_PREENCODE
+	uint8_t *mEncoded;
+	int mEncodedSize;
+#endif
 public:
+#ifdef FASTLED_ESP8266_PREENCODE
+	ClocklessController() : mEncoded(NULL), mEncodedSize(0) {}
+#endif
+
 	virtual void init() {
 		FastPin<DATA_PIN>::setOutput();
 		mPinMask = FastPin<DATA_PIN>::mask();
@@ -37,7 +61,23 @@ protected:
 
 	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
     // mWait.wait();
+		uint32_t start = __clock_cycles();
 		int cnt = FASTLED_INTERRUPT_RETRY_COUNT;
+#ifdef FASTLED_ESP8266_PREENCODE
+    const uint8_t *encoded = encode(pixels);
+    if(encoded != NULL) {
+      while((showEncoded(encoded, pixels.size())==0) && cnt--) {
+        #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+        _retry_cnt++;
+        #endif
+        os_intr_unlock();
+        delayMicroseconds(WAIT_TIME);
+        os_intr_lock();
+      }
+      this->recordFrame(cnt >= 0, FASTLED_INTERRUPT_RETRY_COUNT - (cnt < 0 ? 0 : cnt), __clock_cycles() - start);
+      return;
+    }
+#endif
     while((showRGBInternal(pixels)==0) && cnt--) {
       #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
       _retry_cnt++;
@@ -46,6 +86,7 @@ protected:
       delayMicroseconds(WAIT_TIME);
       os_intr_lock();
     }
+    this->recordFrame(cnt >= 0, FASTLED_INTERRUPT_RETRY_COUNT - (cnt < 0 ? 0 : cnt), __clock_cycles() - start);
     // mWait.mark();
   }
 
@@ -53,20 +94,63 @@ protected:
 #define _ESP_ADJ2 (0)
 
 	template<int BITS> __attribute__ ((always_inline)) inline static void writeBits(register uint32_t & last_mark, register uint32_t b)  {
-    b = ~b; b <<= 24;
-    for(register uint32_t i = BITS; i > 0; i--) {
-      while((__clock_cycles() - last_mark) < (T1+T2+T3));
-			last_mark = __clock_cycles();
-      FastPin<DATA_PIN>::hi();
-
-      while((__clock_cycles() - last_mark) < T1);
-      if(b & 0x80000000L) { FastPin<DATA_PIN>::lo(); }
-      b <<= 1;
-
-      while((__clock_cycles() - last_mark) < (T1+T2));
-      FastPin<DATA_PIN>::lo();
+		clocklessWriteBits<BITS, T1, T2, T3, CycleClock, DataPin>(last_mark, b);
+	}
+
+#ifdef FASTLED_ESP8266_PREENCODE
+	// Convert the frame into wire order, stepping the dithering like showRGBInternal.
+	// Returns NULL if the buffer can't be allocated.
+	const uint8_t *encode(PixelController<RGB_ORDER> pixels) {
+		int size = pixels.size() * 3;
+		if(size > mEncodedSize) {
+			free(mEncoded);
+			mEncoded = (uint8_t*)malloc(size);
+			mEncodedSize = (mEncoded != NULL) ? size : 0;
+			if(mEncoded == NULL) { return NULL; }
+		}
+		uint8_t *out = mEncoded;
+		pixels.preStepFirstByteDithering();
+		uint8_t b = pixels.loadAndScale0();
+		pixels.preStepFirstByteDithering();
+		while(pixels.has(1)) {
+			*out++ = b;
+			*out++ = pixels.loadAndScale1();
+			*out++ = pixels.loadAndScale2();
+			b = pixels.advanceAndLoadAndScale0();
+			pixels.stepDithering();
 		}
+		return mEncoded;
+	}
+
+	// Like showRGBInternal, but for a frame in wire order
+	static uint32_t ICACHE_RAM_ATTR showEncoded(const uint8_t *data, int leds) {
+		const uint8_t *end = data + leds * 3;
+		os_intr_lock();
+    uint32_t start = __clock_cycles();
+		uint32_t last_mark = start;
+		while(data != end) {
+			writeBits<8+XTRA0>(last_mark, data[0]);
+			writeBits<8+XTRA0>(last_mark, data[1]);
+			writeBits<8+XTRA0>(last_mark, data[2]);
+			data += 3;
+
+			#if (FASTLED_ALLOW_INTERRUPTS == 1)
+			os_intr_unlock();
+			os_intr_lock();
+			// if interrupts took longer than 45µs, punt on the current frame
+			if((int32_t)(__clock_cycles()-last_mark) > 0) {
+				if((int32_t)(__clock_cycles()-last_mark) > (T1+T2+T3+((WAIT_TIME-INTERRUPT_THRESHOLD)*CLKS_PER_US))) { sei(); return 0; }
+			}
+			#endif
+		};
+
+		os_intr_unlock();
+    #ifdef FASTLED_DEBUG_COUNT_FRAME_RETRIES
+    _frame_cnt++;
+    #endif
+		return __clock_cycles() - start;
 	}
+#endif
 
 	// This method is made static to force making register Y available to use for data on AVR - if the method is non-static, then
 	// gcc will use register Y for the this pointer.
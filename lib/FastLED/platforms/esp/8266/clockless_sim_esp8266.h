@@ -0,0 +1,139 @@
+#ifndef __INC_CLOCKLESS_SIM_ESP8266_H
+#define __INC_CLOCKLESS_SIM_ESP8266_H
+
+#include "clockless_bits_esp8266.h"
+
+// Host simulation of ClocklessController::writeBits (clockless_esp8266.h), to check the
+// T1/T2/T3 timings of chipsets.h without a strip. The same loop (clocklessWriteBits) runs
+// against a modeled cycle counter, and the resulting pulses are compared with the
+// datasheet tolerances. Only depends on <stdint.h>, so it can be compiled for the host, e.g.:
+//
+//   ClocklessModel model = ESP8266_CLOCKLESS_MODEL;
+//   ClocklessReport report = simulateClockless<NS(250), NS(625), NS(375)>(data, sizeof(data), model);
+//   bool ok = report.within(WS2812B_TOLERANCE);
+
+// Tolerances of the pulses of a chipset (in ns)
+struct ClocklessTolerance {
+	uint16_t minT0H, maxT0H;
+	uint16_t minT1H, maxT1H;
+	uint16_t minPeriod, maxPeriod;
+};
+
+// From the datasheets: T0H, T1H and T0H + T0L (T1H + T1L)
+#define WS2812B_TOLERANCE { 250, 550, 650, 950, 650, 1850 }
+#define SK6812_TOLERANCE  { 150, 450, 450, 750, 650, 1850 }
+#define WS2811_TOLERANCE  { 100, 400, 450, 750, 950, 1550 } // High speed mode
+
+// Model of the cpu executing writeBits
+struct ClocklessModel {
+	// Clock of the cpu (in MHz)
+	uint16_t cpuMHz;
+	// Cycles for one check of the cycle counter in the wait loops
+	uint8_t pollCycles;
+	// Cycles to write the pin
+	uint8_t writeCycles;
+	// Cycles between two bytes, to load, dither and scale the next byte
+	uint8_t loadCycles;
+};
+
+#define ESP8266_CLOCKLESS_MODEL { 80, 4, 2, 20 }
+
+// The measured pulses (in ns)
+struct ClocklessReport {
+	uint32_t bits;
+	uint16_t minT0H, maxT0H;
+	uint16_t minT1H, maxT1H;
+	uint16_t minPeriod, maxPeriod;
+
+	bool within(const ClocklessTolerance & t) const {
+		return minT0H >= t.minT0H && maxT0H <= t.maxT0H &&
+			minT1H >= t.minT1H && maxT1H <= t.maxT1H &&
+			minPeriod >= t.minPeriod && maxPeriod <= t.maxPeriod;
+	}
+};
+
+// State of the simulated cpu and data line
+struct ClocklessSimState {
+	ClocklessModel model;
+	ClocklessReport report;
+	uint32_t cycles;
+	uint32_t rise, lastRise;
+	bool high, one, first;
+	// The bits of the current byte, as shifted by clocklessWriteBits
+	uint32_t bits;
+};
+
+inline ClocklessSimState & _clocklessSim() {
+	static ClocklessSimState state;
+	return state;
+}
+
+// Convert cycles to ns
+inline uint16_t _clocklessSimNS(uint32_t cycles) {
+	return (uint16_t)((cycles * 1000) / _clocklessSim().model.cpuMHz);
+}
+
+// Each read of the counter takes the time of a poll
+struct ClocklessSimClock {
+	static uint32_t cycles() {
+		ClocklessSimState & s = _clocklessSim();
+		uint32_t now = s.cycles;
+		s.cycles += s.model.pollCycles;
+		return now;
+	}
+};
+
+// Measures the pulses on the data line
+struct ClocklessSimPin {
+	static void hi() {
+		ClocklessSimState & s = _clocklessSim();
+		s.cycles += s.model.writeCycles;
+		s.rise = s.cycles;
+		s.high = true;
+		s.one = !(s.bits & 0x80000000L);
+		s.bits <<= 1;
+		if(!s.first) {
+			uint16_t period = _clocklessSimNS(s.rise - s.lastRise);
+			if(period < s.report.minPeriod) { s.report.minPeriod = period; }
+			if(period > s.report.maxPeriod) { s.report.maxPeriod = period; }
+		}
+		s.first = false;
+		s.lastRise = s.rise;
+		s.report.bits++;
+	}
+
+	static void lo() {
+		ClocklessSimState & s = _clocklessSim();
+		s.cycles += s.model.writeCycles;
+		if(!s.high) { return; }
+		s.high = false;
+		uint16_t high = _clocklessSimNS(s.cycles - s.rise);
+		if(s.one) {
+			if(high < s.report.minT1H) { s.report.minT1H = high; }
+			if(high > s.report.maxT1H) { s.report.maxT1H = high; }
+		} else {
+			if(high < s.report.minT0H) { s.report.minT0H = high; }
+			if(high > s.report.maxT0H) { s.report.maxT0H = high; }
+		}
+	}
+};
+
+template<int T1, int T2, int T3, int XTRA0 = 0>
+ClocklessReport simulateClockless(const uint8_t *data, int length, const ClocklessModel & model) {
+	ClocklessSimState & s = _clocklessSim();
+	ClocklessReport report = { 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0 };
+	s.model = model;
+	s.report = report;
+	s.cycles = 0;
+	s.high = false;
+	s.first = true;
+	uint32_t last_mark = 0;
+	for(int i = 0; i < length; i++) {
+		s.bits = ~(uint32_t)data[i] << 24;
+		clocklessWriteBits<8 + XTRA0, T1, T2, T3, ClocklessSimClock, ClocklessSimPin>(last_mark, data[i]);
+		s.cycles += model.loadCycles;
+	}
+	return s.report;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __INC_CLOCKLESS_UART_ESP8266_H
+#define __INC_CLOCKLESS_UART_ESP8266_H
+
+#include "uart_encode_esp8266.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+#define FASTLED_HAS_UART_CLOCKLESS 1
+
+// WS2812 output through the hardware UART1 (TX on GPIO2), an alternative to the
+// bit-banged ClocklessController. The pixels are encoded into UART symbols (see
+// uart_encode_esp8266.h), and the UART shifts them out from its 128 byte FIFO,
+// so interrupts are never disabled. A symbol takes 2.5µs, and the FIFO is refilled
+// as soon as the 12 symbols of a pixel fit, so it holds at least 116 symbols
+// (290µs). An interrupt or WiFi task running longer than ~290µs still empties
+// the FIFO, and the strip takes the gap as the end of the frame.
+//
+// Serial1 can't be used together with this controller. Usage:
+//
+//   UARTController<GRB> controller;
+//   FastLED.addLeds(&controller, leds, NUM_LEDS);
+template <EOrder RGB_ORDER = GRB, int RESET_US = 300>
+class UARTController : public CPixelLEDController<RGB_ORDER> {
+	CMinWait<RESET_US> mWait;
+
+	static uint16_t fifoCount() { return (USS(UART1) >> USTXC) & 0xFF; }
+
+public:
+	virtual void init() {
+		Serial1.begin(3200000, SERIAL_6N1, SERIAL_TX_ONLY);
+		// Idle low, start bit high
+		USC0(UART1) |= (1 << UCTXI);
+	}
+
+	virtual uint16_t getMaxRefreshRate() const { return 400; }
+
+protected:
+
+	virtual void showPixels(PixelController<RGB_ORDER> & pixels) {
+		uint8_t symbols[3 * UART_SYMBOLS_PER_BYTE];
+		mWait.wait();
+		uint32_t start = __clock_cycles();
+		pixels.preStepFirstByteDithering();
+		while(pixels.has(1)) {
+			uartEncodeByte(pixels.loadAndScale0(), symbols);
+			uartEncodeByte(pixels.loadAndScale1(), symbols + UART_SYMBOLS_PER_BYTE);
+			uartEncodeByte(pixels.loadAndScale2(), symbols + 2 * UART_SYMBOLS_PER_BYTE);
+			pixels.advanceData();
+			pixels.stepDithering();
+
+			while(fifoCount() > UART_TX_FIFO_SIZE - sizeof(symbols));
+			for(uint8_t i = 0; i < sizeof(symbols); i++) {
+				USF(UART1) = symbols[i];
+			}
+		}
+		// The reset time starts when the last symbol left the FIFO
+		while(fifoCount() > 0);
+		mWait.mark();
+		this->recordFrame(true, 0, __clock_cycles() - start);
+	}
+};
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -5,3 +5,4 @@
 #include "fastpin_esp8266.h"
 #include "clockless_esp8266.h"
 #include "clockless_block_esp8266.h"
+#include "clockless_uart_esp8266.h"
@@ -0,0 +1,44 @@
+#ifndef __INC_UART_ENCODE_ESP8266_H
+#define __INC_UART_ENCODE_ESP8266_H
+
+#include <stdint.h>
+
+// Encoding of WS2812 bits into UART symbols, for the UART based controller.
+//
+// The UART runs at 3.2 Mbaud with 6N1 frames and an inverted TX line, so
+// one frame is 8 periods of 312.5ns: start bit (high), 6 data bits (inverted,
+// LSB first), stop bit (low). Each frame carries two WS2812 bits of 4 periods:
+//
+//   0 bit: high 1 period  (312.5ns), low 3 periods  -> T0H 0.31µs, T0L 0.94µs
+//   1 bit: high 3 periods (937.5ns), low 1 period   -> T1H 0.94µs, T1L 0.31µs
+//
+// The first bit always begins with the start bit, the second bit always ends
+// with the stop bit. A data byte becomes 4 symbols, most significant bits first.
+
+#define UART_SYMBOLS_PER_BYTE 4
+
+// Symbols for two bits (first << 1 | second), before the inversion of the line
+static const uint8_t _uart_symbols[4] = {
+	0b110111, // 0 0
+	0b000111, // 0 1
+	0b110100, // 1 0
+	0b000100  // 1 1
+};
+
+// Encode a single byte into 4 symbols
+__attribute__ ((always_inline)) inline static void uartEncodeByte(uint8_t b, uint8_t *symbols) {
+	symbols[0] = _uart_symbols[(b >> 6) & 0x03];
+	symbols[1] = _uart_symbols[(b >> 4) & 0x03];
+	symbols[2] = _uart_symbols[(b >> 2) & 0x03];
+	symbols[3] = _uart_symbols[b & 0x03];
+}
+
+// Encode 'length' bytes into 'length * UART_SYMBOLS_PER_BYTE' symbols
+inline static void uartEncode(const uint8_t *data, uint16_t length, uint8_t *symbols) {
+	for(uint16_t i = 0; i < length; i++) {
+		uartEncodeByte(data[i], symbols);
+		symbols += UART_SYMBOLS_PER_BYTE;
+	}
+}
+
+#endif
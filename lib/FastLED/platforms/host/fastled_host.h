@@ -0,0 +1,7 @@
+#pragma once
+
+#include "bitswap.h"
+#include "fastled_delay.h"
+
+// Pins are never accessed on the host, FastPin fails for any pin
+#define HAS_HARDWARE_PIN_SUPPORT
@@ -0,0 +1,33 @@
+#pragma once
+
+// Host builds (tests and simulations) use a mock of the Arduino core
+#include <Arduino.h>
+
+// Use the millis timer of the mock
+#define FASTLED_HAS_MILLIS
+
+typedef volatile uint32_t RoReg;
+typedef volatile uint32_t RwReg;
+typedef uint32_t prog_uint32_t;
+
+// Data is plain memory on the host
+#ifndef FASTLED_USE_PROGMEM
+# define FASTLED_USE_PROGMEM 0
+#endif
+
+#ifndef FASTLED_ALLOW_INTERRUPTS
+# define FASTLED_ALLOW_INTERRUPTS 1
+# define INTERRUPT_THRESHOLD 0
+#endif
+
+// There are no pins, only controllers without hardware (e.g. FrameRecorder)
+#define FASTLED_NO_PINMAP
+
+// There are no interrupts to disable
+#define cli()
+#define sei()
+
+// Timing constants are computed for the clock of the target
+#ifndef F_CPU
+# define F_CPU 80000000L
+#endif
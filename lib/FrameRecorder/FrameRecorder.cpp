@@ -0,0 +1,95 @@
+#include <FrameRecorder.h>
+
+FrameRecorderBase::FrameRecorderBase(FrameRecord* frameRecords, CRGB* framePixels, uint16_t frameLeds, uint16_t frames) {
+    records = frameRecords;
+    pixels = framePixels;
+    maxLeds = frameLeds;
+    capacity = frames;
+    recorded = 0;
+}
+
+uint16_t FrameRecorderBase::slot(uint16_t index) {
+    if (recorded <= capacity) {
+        return index;
+    }
+    return (recorded + index) % capacity;
+}
+
+void FrameRecorderBase::record(const CRGB* data, int nLeds, CRGB scale, uint8_t flags) {
+    uint16_t position = recorded % capacity;
+    FrameRecord* frame = &records[position];
+    frame->time = micros();
+    frame->leds = nLeds;
+    frame->flags = flags;
+    frame->scale = scale;
+    uint16_t stored = (flags & FRAME_SOLID) ? 1 : min(nLeds, (int) maxLeds);
+    memcpy((uint8_t*) (pixels + (uint32_t) position * maxLeds), (const uint8_t*) data, stored * sizeof(CRGB));
+    recorded += 1;
+    recordFrame(true, 0, 0);
+}
+
+void FrameRecorderBase::showColor(const CRGB& data, int nLeds, CRGB scale) {
+    if (skipFrame(data.raw, 3, nLeds, scale)) {
+        return;
+    }
+    markShown();
+    record(&data, nLeds, scale, FRAME_SOLID);
+}
+
+void FrameRecorderBase::show(const CRGB* data, int nLeds, CRGB scale) {
+    if (skipFrame((const uint8_t*) data, nLeds * 3, nLeds, scale)) {
+        return;
+    }
+    markShown();
+    record(data, nLeds, scale, 0);
+}
+
+size_t FrameRecorderBase::writeTrace(Print& out) {
+    size_t bytes = out.write((const uint8_t*) FRAME_TRACE_MAGIC, 4);
+    for (uint16_t i = 0; i < getCount(); i += 1) {
+        const FrameRecord& frame = getFrame(i);
+        uint8_t header[10] = {
+            (uint8_t) frame.time, (uint8_t) (frame.time >> 8),
+            (uint8_t) (frame.time >> 16), (uint8_t) (frame.time >> 24),
+            (uint8_t) frame.leds, (uint8_t) (frame.leds >> 8),
+            frame.flags, frame.scale.r, frame.scale.g, frame.scale.b
+        };
+        bytes += out.write(header, sizeof(header));
+        // Leds cut from long frames are sent as black
+        uint16_t leds = (frame.flags & FRAME_SOLID) ? 1 : frame.leds;
+        const CRGB* data = getPixels(i);
+        for (uint16_t led = 0; led < leds; led += 1) {
+            CRGB pixel = (led < maxLeds) ? data[led] : CRGB::Black;
+            bytes += out.write(pixel.raw, 3);
+        }
+    }
+    return bytes;
+}
+
+size_t FrameRecorderBase::writePPM(Print& out) {
+    uint16_t width = 0;
+    for (uint16_t i = 0; i < getCount(); i += 1) {
+        uint16_t leds = min(getFrame(i).leds, maxLeds);
+        if (leds > width) {
+            width = leds;
+        }
+    }
+    char header[24];
+    sprintf(header, "P6\n%u %u\n255\n", width, getCount());
+    size_t bytes = out.write((const uint8_t*) header, strlen(header));
+    for (uint16_t i = 0; i < getCount(); i += 1) {
+        const FrameRecord& frame = getFrame(i);
+        const CRGB* data = getPixels(i);
+        for (uint16_t led = 0; led < width; led += 1) {
+            CRGB pixel = CRGB::Black;
+            if (led < frame.leds) {
+                pixel = (frame.flags & FRAME_SOLID) ? data[0] : data[led];
+                pixel.r = scale8(pixel.r, frame.scale.r);
+                pixel.g = scale8(pixel.g, frame.scale.g);
+                pixel.b = scale8(pixel.b, frame.scale.b);
+            }
+            bytes += out.write(pixel.raw, 3);
+        }
+    }
+    return bytes;
+}
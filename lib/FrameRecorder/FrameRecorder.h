@@ -0,0 +1,116 @@
+#ifndef __FRAME_RECORDER_H
+#define __FRAME_RECORDER_H
+
+#include <FastLED.h>
+
+/* The first bytes of a binary trace */
+#define FRAME_TRACE_MAGIC "FRT1"
+
+/* Set for frames showing a single color on all leds */
+#define FRAME_SOLID 0x01
+
+/* A frame recorded by a FrameRecorder */
+struct FrameRecord {
+    /* Time of the show (in µs, see micros()) */
+    uint32_t time;
+
+    /* The number of leds shown */
+    uint16_t leds;
+
+    /* FRAME_SOLID for frames from 'showColor()' */
+    uint8_t flags;
+
+    /* The brightness and color adjustment of the frame */
+    CRGB scale;
+};
+
+/**
+ A controller without hardware, which records the frames shown instead,
+ e.g. to test the blending of colors on the host. The last frames are
+ kept in a ring buffer, see 'FrameRecorder' for the memory.
+ */
+class FrameRecorderBase : public CLEDController {
+
+    /* The records of the frames */
+    FrameRecord* records;
+
+    /* The leds of the frames, 'maxLeds' per frame */
+    CRGB* pixels;
+
+    /* The number of leds stored per frame, longer frames are cut */
+    uint16_t maxLeds;
+
+    /* The number of frames in the ring buffer */
+    uint16_t capacity;
+
+    /* The number of frames recorded since the last 'clear()' */
+    uint32_t recorded;
+
+    /* Add a frame to the ring buffer */
+    void record(const CRGB* data, int nLeds, CRGB scale, uint8_t flags);
+
+    /* The position of a frame in the ring buffer, 0 is the oldest frame */
+    uint16_t slot(uint16_t index);
+
+protected:
+
+    FrameRecorderBase(FrameRecord* frameRecords, CRGB* framePixels, uint16_t frameLeds, uint16_t frames);
+
+    virtual void showColor(const CRGB& data, int nLeds, CRGB scale);
+
+    virtual void show(const CRGB* data, int nLeds, CRGB scale);
+
+public:
+
+    virtual void init() { }
+
+    /* The number of frames recorded since the last 'clear()' */
+    uint32_t getRecorded() {
+        return recorded;
+    }
+
+    /* The number of frames in the buffer */
+    uint16_t getCount() {
+        return (recorded < capacity) ? recorded : capacity;
+    }
+
+    /* A frame in the buffer, 0 is the oldest frame */
+    const FrameRecord& getFrame(uint16_t index) {
+        return records[slot(index)];
+    }
+
+    /* The leds of a frame in the buffer (a single led for solid frames) */
+    const CRGB* getPixels(uint16_t index) {
+        return pixels + (uint32_t) slot(index) * maxLeds;
+    }
+
+    /* Remove all frames */
+    void clear() {
+        recorded = 0;
+    }
+
+    /**
+     Write the frames as binary trace: FRAME_TRACE_MAGIC, then for each frame
+     the time (4 bytes), the number of leds (2 bytes), the flags, the scale
+     (3 bytes) and the leds (3 bytes each, a single led for solid frames).
+     Numbers are little endian. Returns the number of bytes written.
+     */
+    size_t writeTrace(Print& out);
+
+    /**
+     Write the frames as binary PPM image (P6), one row per frame with the
+     leds as shown, with the scale applied. Returns the number of bytes written.
+     */
+    size_t writePPM(Print& out);
+};
+
+/* A recorder for the last FRAMES frames with up to LEDS leds */
+template<uint16_t LEDS, uint16_t FRAMES> class FrameRecorder : public FrameRecorderBase {
+    FrameRecord frameRecords[FRAMES];
+    CRGB framePixels[FRAMES * LEDS];
+
+public:
+    FrameRecorder() : FrameRecorderBase(frameRecords, framePixels, LEDS, FRAMES) { }
+};
+
+#endif
@@ -1,6 +1,299 @@
-
 #include <SimpleScheduler.h>    /* Simple task scheduling */
 
+#include <new>                  /* Placement new for the pool */
+
+/* Memory for the tasks created at runtime */
+static uint64_t taskPool[TASK_POOL_SIZE][(sizeof(Task) + 7) / 8];
+
 /* Initialize static members */
 Task* Task::first = 0;
-Task* Task::currentTask = 0;
+Task* Task::heap[TASKS_MAX];
+uint8_t Task::heapSize = 0;
+uint32_t Task::lastMicros = 0;
+uint32_t Task::microsOverflows = 0;
+uint64_t Task::idleTime = 0;
+uint32_t Task::poolUsed = 0;
+uint32_t Task::poolReleased = 0;
+bool Task::dispatching = false;
+bool Task::started = false;
+uint32_t Task::overflows = 0;
+
+uint64_t Task::now() {
+    uint32_t time = micros();
+    if (time < lastMicros) {
+        microsOverflows += 1;
+    }
+    lastMicros = time;
+    return ((uint64_t) microsOverflows << 32) | time;
+}
+
+void Task::init(uint32_t interval, bool enable, uint8_t priority, const char* taskName) {
+    inter = interval;
+    once = false;
+    name = taskName;
+    resetStats();
+    enabled = enable;
+    prio = priority;
+    position = TASK_UNSCHEDULED;
+    missed = 0;
+    overrun = OVERRUN_SKIP;
+    // Relative to the start, until the task is scheduled by 'begin()'
+    nextExecution = (uint64_t) interval * 1000;
+    next = first;
+    first = this;
+    if (started && enabled) {
+        nextExecution += now();
+        schedule();
+    }
+}
+
+void Task::begin() {
+    if (started) {
+        return;
+    }
+    started = true;
+    uint64_t time = now();
+    for (Task* task = first; task != 0; task = task->next) {
+        if (task->enabled && task->position == TASK_UNSCHEDULED) {
+            task->nextExecution += time;
+            task->schedule();
+        }
+    }
+}
+
+Task::~Task() {
+    enabled = false;
+    unschedule();
+    Task** link = &first;
+    while (*link != 0 && *link != this) {
+        link = &(*link)->next;
+    }
+    if (*link == this) {
+        *link = next;
+    }
+    func = 0;
+}
+
+int8_t Task::poolSlot() {
+    uint8_t* start = (uint8_t*) taskPool;
+    uint8_t* address = (uint8_t*) this;
+    if (address < start || address >= start + sizeof(taskPool)) {
+        return -1;
+    }
+    return (address - start) / sizeof(taskPool[0]);
+}
+
+Task* Task::create(void (*function) (void), uint32_t interval, bool once, uint8_t priority, const char* taskName) {
+    for (uint8_t i = 0; i < TASK_POOL_SIZE; i += 1) {
+        uint32_t mask = 1UL << i;
+        if ((poolUsed | poolReleased) & mask) {
+            continue;
+        }
+        Task* task = new (taskPool[i]) Task(function, interval, true, priority, taskName);
+        if (!task->enabled) {
+            // The heap is full, the task would never run
+            task->~Task();
+            return 0;
+        }
+        poolUsed |= mask;
+        task->once = once;
+        return task;
+    }
+    return 0;
+}
+
+/**
+ A task released while tasks are running may still be in the list of due
+ tasks, so its memory is only reused after 'runTasks()' is done.
+ */
+void Task::release() {
+    int8_t slot = poolSlot();
+    if (slot < 0) {
+        disable();
+        return;
+    }
+    uint32_t mask = 1UL << slot;
+    if (!(poolUsed & mask)) {
+        return;
+    }
+    this->~Task();
+    poolUsed &= ~mask;
+    if (dispatching) {
+        poolReleased |= mask;
+    }
+}
+
+void Task::record(uint32_t cycles, uint64_t late) {
+    stats.count += 1;
+    stats.totalCycles += cycles;
+    if (cycles < stats.minCycles) {
+        stats.minCycles = cycles;
+    }
+    if (cycles > stats.maxCycles) {
+        stats.maxCycles = cycles;
+    }
+    uint64_t steps = late / TASK_LATENESS_STEP;
+    uint8_t bin = 0;
+    while (steps != 0 && bin < TASK_LATENESS_BINS - 1) {
+        steps >>= 1;
+        bin += 1;
+    }
+    stats.lateness[bin] += 1;
+}
+
+/**
+ The execution at 'nextExecution' happened at 'time'. If the following
+ execution is already due, at least one interval was missed.
+ */
+void Task::reschedule(uint64_t time) {
+    uint64_t period = (uint64_t) inter * 1000;
+    uint64_t following = nextExecution + period;
+    if (following > time || period == 0) {
+        nextExecution = following;
+        return;
+    }
+    uint64_t late = (time - nextExecution) / period;
+    switch (overrun) {
+        // The executions are not missed, they follow as soon as possible
+        case OVERRUN_CATCH_UP: nextExecution = following; break;
+        case OVERRUN_REALIGN:  missed += late; nextExecution = time + period; break;
+        default:               missed += late; nextExecution += (late + 1) * period; break;
+    }
+}
+
+void Task::siftUp(uint8_t index) {
+    Task* task = heap[index];
+    while (index > 0) {
+        uint8_t parent = (index - 1) / 2;
+        if (!task->before(heap[parent])) {
+            break;
+        }
+        heap[index] = heap[parent];
+        heap[index]->position = index;
+        index = parent;
+    }
+    heap[index] = task;
+    task->position = index;
+}
+
+void Task::siftDown(uint8_t index) {
+    Task* task = heap[index];
+    while (true) {
+        uint8_t child = 2 * index + 1;
+        if (child >= heapSize) {
+            break;
+        }
+        if (child + 1 < heapSize && heap[child + 1]->before(heap[child])) {
+            child += 1;
+        }
+        if (!heap[child]->before(task)) {
+            break;
+        }
+        heap[index] = heap[child];
+        heap[index]->position = index;
+        index = child;
+    }
+    heap[index] = task;
+    task->position = index;
+}
+
+Task* Task::removeAt(uint8_t index) {
+    Task* task = heap[index];
+    task->position = TASK_UNSCHEDULED;
+    heapSize -= 1;
+    if (index < heapSize) {
+        Task* moved = heap[heapSize];
+        heap[index] = moved;
+        siftDown(index);
+        siftUp(moved->position);
+    }
+    return task;
+}
+
+bool Task::schedule() {
+    if (position == TASK_UNSCHEDULED) {
+        if (heapSize == TASKS_MAX) {
+            overflows += 1;
+            enabled = false;
+            return false;
+        }
+        heap[heapSize] = this;
+        heapSize += 1;
+        siftUp(heapSize - 1);
+    } else {
+        siftUp(position);
+        siftDown(position);
+    }
+    return true;
+}
+
+void Task::unschedule() {
+    if (position != TASK_UNSCHEDULED) {
+        removeAt(position);
+    }
+}
+
+/**
+ All due tasks are taken from the heap first, so that each task runs at
+ most once per call, even if it is still due after its execution.
+ */
+void Task::runTasks() {
+    begin();
+    uint64_t time = now();
+    Task* due[TASKS_MAX];
+    uint8_t count = 0;
+    while (heapSize > 0 && heap[0]->nextExecution <= time) {
+        due[count] = removeAt(0);
+        count += 1;
+    }
+
+    dispatching = true;
+    for (uint8_t i = 0; i < count; i += 1) {
+        Task* task = due[i];
+        // Skip tasks disabled, released or rescheduled by previous tasks
+        if (!task->enabled || task->position != TASK_UNSCHEDULED) {
+            continue;
+        }
+        // Tasks before in this batch delay the task, so read the time again
+        uint64_t started = now();
+        uint64_t late = started - task->nextExecution;
+        task->reschedule(started);
+        task->schedule();
+        uint32_t start = taskCycles();
+        task->func();
+        uint32_t cycles = taskCycles() - start;
+        // The task may have released itself
+        if (task->func == 0) {
+            continue;
+        }
+        task->record(cycles, late);
+        if (task->once) {
+            task->release();
+        }
+    }
+    dispatching = false;
+    poolReleased = 0;
+}
+
+void Task::waitForNextTask(uint32_t maxMillis, bool (*wake) (void)) {
+    uint64_t time = now();
+    uint32_t wait = maxMillis;
+    if (heapSize > 0) {
+        if (heap[0]->nextExecution <= time) {
+            return;
+        }
+        uint64_t remaining = (heap[0]->nextExecution - time) / 1000;
+        if (remaining < wait) {
+            wait = remaining;
+        }
+    }
+    while (wait > 0) {
+        uint32_t slice = (wake == 0 || wait < TASK_SLEEP_SLICE) ? wait : TASK_SLEEP_SLICE;
+        delay(slice);
+        wait -= slice;
+        if (wake != 0 && wake()) {
+            break;
+        }
+    }
+    idleTime += now() - time;
+}
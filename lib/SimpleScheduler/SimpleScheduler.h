@@ -3,69 +3,240 @@
 
 #include <Arduino.h>
 
-/* VERY simple task scheduling */
+/* The maximum number of enabled tasks (at most 254) */
+#ifndef TASKS_MAX
+#define TASKS_MAX 64
+#endif
+
+/* The number of tasks which can be created at runtime (at most 32) */
+#ifndef TASK_POOL_SIZE
+#define TASK_POOL_SIZE 8
+#endif
+
+/* The longest sleep of 'waitForNextTask()' between two wake checks (in ms) */
+#ifndef TASK_SLEEP_SLICE
+#define TASK_SLEEP_SLICE 2
+#endif
+
+/* Position of a task which is not scheduled */
+#define TASK_UNSCHEDULED 0xFF
+
+/* What to do when a task missed one or more executions */
+#define OVERRUN_SKIP     0 // Drop the missed executions, keep the phase of the interval
+#define OVERRUN_CATCH_UP 1 // Run the missed executions as soon as possible
+#define OVERRUN_REALIGN  2 // Restart the interval at the late execution
+
+/* The number of bins of the lateness histogram */
+#define TASK_LATENESS_BINS 8
+
+/* The lateness (in µs) covered by the first bin, each following bin doubles */
+#define TASK_LATENESS_STEP 250
+
+/* Runtime statistics of a task */
+struct TaskStats {
+    /* The number of executions */
+    uint32_t count;
+
+    /* The shortest execution (in cycles) */
+    uint32_t minCycles;
+
+    /* The longest execution (in cycles) */
+    uint32_t maxCycles;
+
+    /* The sum of all executions (in cycles) */
+    uint64_t totalCycles;
+
+    /* Executions by lateness: < 250 µs, < 500 µs, < 1 ms, ..., >= 16 ms */
+    uint32_t lateness[TASK_LATENESS_BINS];
+};
+
+/* Read the cycle counter, used to measure the runtime of tasks */
+static inline uint32_t taskCycles() {
+#ifdef ESP8266
+    return ESP.getCycleCount();
+#else
+    return micros() * clockCyclesPerMicrosecond();
+#endif
+}
+
+/* Simple task scheduling, ordered by the time of the next execution */
 class Task {
     /* The first task in the linked list */
     static Task* first;
 
-    /* The current task to execute */
-    static Task* currentTask;
+    /* The enabled tasks as a binary min-heap, ordered by next execution */
+    static Task* heap[TASKS_MAX];
+
+    /* The number of tasks in the heap */
+    static uint8_t heapSize;
+
+    /* The last value of micros(), to detect the overflow */
+    static uint32_t lastMicros;
+
+    /* The number of overflows of micros() */
+    static uint32_t microsOverflows;
+
+    /* The total time spent waiting for tasks (in µs) */
+    static uint64_t idleTime;
+
+    /* The slots of the pool in use, one bit per slot */
+    static uint32_t poolUsed;
+
+    /* The slots released while tasks are running, free after 'runTasks()' */
+    static uint32_t poolReleased;
+
+    /* Indicate if 'runTasks()' is executing tasks */
+    static bool dispatching;
+
+    /* Indicate if 'begin()' was called, tasks constructed before wait for it */
+    static bool started;
+
+    /* The number of times a task couldn't be enabled, because TASKS_MAX tasks were enabled */
+    static uint32_t overflows;
 
     /* Pointer to next task */
     Task* next;
 
-    /* The interval and timeStamp of execution */
+    /* The interval of execution (in ms) */
     uint32_t inter;
 
-    /* The timeStamp of execution */
-    uint32_t nextExecution;
+    /* The timeStamp of execution (in µs, see 'now()') */
+    uint64_t nextExecution;
+
+    /* The number of executions dropped because of overruns */
+    uint32_t missed;
+
+    /* One of the OVERRUN_* policies */
+    uint8_t overrun;
+
+    /* The position in the heap, or TASK_UNSCHEDULED */
+    uint8_t position;
+
+    /* Tasks with higher priority run first when due at the same time */
+    uint8_t prio;
 
     /* If the task should be executed */
     bool enabled;
 
+    /* If the task is released after its first execution */
+    bool once;
+
     /* The function to be executed */
     void (*func) (void);
 
+    /* The name of the task, used for statistics */
+    const char* name;
+
+    /* Runtime statistics */
+    TaskStats stats;
+
+    /* Add an execution to the statistics */
+    void record(uint32_t cycles, uint64_t late);
+
+    /* The slot of the task in the pool, or -1 if not created from the pool */
+    int8_t poolSlot();
+
+    /* Set up the task and add it to the list */
+    void init(uint32_t interval, bool enable, uint8_t priority, const char* taskName);
+
+    /* Returns true, if the task should run before the other task */
+    bool before(Task* other) {
+        return nextExecution < other->nextExecution ||
+            (nextExecution == other->nextExecution && prio > other->prio);
+    }
+
+    /* Set the next execution after the task ran late or on time */
+    void reschedule(uint64_t time);
+
+    /* Move a task towards the top of the heap */
+    static void siftUp(uint8_t index);
+
+    /* Move a task towards the bottom of the heap */
+    static void siftDown(uint8_t index);
+
+    /* Remove the task at the given position from the heap */
+    static Task* removeAt(uint8_t index);
+
+    /**
+     Insert the task into the heap, or update its position. If the heap is
+     full, the task is disabled, counted in 'getOverflows()' and false is returned.
+     */
+    bool schedule();
+
+    /* Remove the task from the heap */
+    void unschedule();
+
 public:
 
     /* Constructor */
-    Task(void (*function) (void), uint32_t interval, bool enable = true) {
-        inter = interval;
+    Task(void (*function) (void), uint32_t interval, bool enable = true, uint8_t priority = 0, const char* taskName = "") {
         func = function;
-        enabled = enable;
-        nextExecution = millis() + interval;
-        next = first;
-        first = this;
-    }
-
-    /* Used to run the tasks */
-    static void runTasks() {
-        /* If no task, start over with the list */
-        if (currentTask == 0) {
-            currentTask = first;
-            return;
-        }
+        init(interval, enable, priority, taskName);
+    }
 
-        /* Run the task when enabled and time is reached */
-        if (currentTask->enabled && (millis() > currentTask->nextExecution)) {
-            currentTask->func();
-            currentTask->nextExecution += currentTask->inter;
-        }
+    /**
+     Create a task from a fixed pool (TASK_POOL_SIZE), without using the heap.
+     A task with 'once' set is released after its first execution, other tasks
+     must be released with 'release()'. Returns 0 if the pool is exhausted,
+     or if TASKS_MAX tasks are already enabled.
+     */
+    static Task* create(void (*function) (void), uint32_t interval, bool once = false, uint8_t priority = 0, const char* taskName = "");
+
+    /**
+     Stop a task and return it to the pool. Can be called from any task,
+     including the task itself. For tasks not created from the pool, this
+     only disables the task.
+     */
+    void release();
+
+    /**
+     Start the tasks enabled by their constructor. Static tasks are constructed
+     before the clock can be used, so they are only scheduled here. Called by
+     the first 'runTasks()', if not called before.
+     */
+    static void begin();
+
+    /* Used to run the tasks. Runs all tasks which are due. */
+    static void runTasks();
+
+    /**
+     Wait until the next task is due, but at most 'maxMillis'. Uses delay(),
+     which lets the ESP8266 handle WiFi and enter light sleep, if enabled.
+     If 'wake' is given, the wait is split into slices of TASK_SLEEP_SLICE ms,
+     and ends early as soon as 'wake' returns true after a slice.
+     */
+    static void waitForNextTask(uint32_t maxMillis, bool (*wake) (void) = 0);
 
-        currentTask = currentTask->next;
+    /* The number of times a task couldn't be enabled, because TASKS_MAX tasks were enabled */
+    static uint32_t getOverflows() {
+        return overflows;
     }
 
-    /* Enable or disable the task */
-    void enable() {
+    /* The total time spent in 'waitForNextTask()' (in µs) */
+    static uint64_t getIdleTime() {
+        return idleTime;
+    }
+
+    /**
+     Monotonic time in µs, which doesn't overflow like millis() after 49.7 days.
+     Must be called at least once every 71 minutes (done by 'runTasks()').
+     */
+    static uint64_t now();
+
+    /* Enable the task, returns false if TASKS_MAX tasks are already enabled */
+    bool enable() {
         if(!enabled) {
             enabled = true;
-            nextExecution = millis();
+            nextExecution = now();
+            return schedule();
         }
+        return true;
     }
 
     /* Disable the task */
     void disable() {
         enabled = false;
+        unschedule();
     }
 
     /* Returns true, if the task is enabled */
@@ -75,8 +246,11 @@ public:
 
     /* Set execution interval */
     void setInterval(uint32_t interval) {
-        nextExecution += interval - inter;
-        interval = inter;
+        nextExecution += ((int64_t) interval - (int64_t) inter) * 1000;
+        inter = interval;
+        if (position != TASK_UNSCHEDULED) {
+            schedule();
+        }
     }
 
     /* Get execution interval */
@@ -84,16 +258,65 @@ public:
         return inter;
     }
 
-    /* Execute the task again after a certain time */
-    void executeIn(uint32_t milliseconds) {
-        nextExecution = millis() + milliseconds;
-        enabled = true;
+    /* Set the priority, used when tasks are due at the same time */
+    void setPriority(uint8_t priority) {
+        prio = priority;
+        if (position != TASK_UNSCHEDULED) {
+            schedule();
+        }
+    }
+
+    /* Set the behaviour for missed executions (one of OVERRUN_*) */
+    void setOverrunPolicy(uint8_t policy) {
+        overrun = policy;
     }
 
-    /* Deleting is not implemented */
-    ~Task() {
-        Serial.println("Delete unimplemented. Use 'disable()'");
+    /**
+     The number of executions dropped because of overruns. Always 0 for
+     OVERRUN_CATCH_UP, since the executions are run late instead.
+     */
+    uint32_t getMissed() {
+        return missed;
     }
+
+    /* The name of the task */
+    const char* getName() {
+        return name;
+    }
+
+    /* Runtime statistics of the task */
+    const TaskStats& getStats() {
+        return stats;
+    }
+
+    /* Clear the runtime statistics */
+    void resetStats() {
+        memset(&stats, 0, sizeof(TaskStats));
+        stats.minCycles = 0xFFFFFFFF;
+    }
+
+    /* The first task, to iterate over all tasks */
+    static Task* getFirst() {
+        return first;
+    }
+
+    /* The next task, or 0 for the last task */
+    Task* getNext() {
+        return next;
+    }
+
+    /**
+     Execute the task again after a certain time. Returns false if the task
+     is not enabled yet, and TASKS_MAX tasks are already enabled.
+     */
+    bool executeIn(uint32_t milliseconds) {
+        nextExecution = now() + (uint64_t) milliseconds * 1000;
+        enabled = true;
+        return schedule();
+    }
+
+    /* Remove the task from the scheduler and the list of tasks */
+    ~Task();
 };
 
 #endif
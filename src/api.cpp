@@ -17,15 +17,18 @@ void handleClient();
 
 void receiveUDPPacket();
 
-Task serverResponse(handleClient, 100);
+Task serverResponse(handleClient, NETWORK_TIME, true, 0, "http");
 
-Task receiveTask(receiveUDPPacket, 100);
+Task receiveTask(receiveUDPPacket, NETWORK_TIME, true, 0, "udp");
 
 /*  Webserver to give access to url api */
 ESP8266WebServer server(SERVER_PORT);
 
 WiFiUDP udp;                       // UDP instance to receive colors
 
+/* Size of a packet found while sleeping, read by the next run of the udp task */
+static uint16_t pendingBytes = 0;
+
 /* WiFi credentials */
 const char* ssid = WIFI_SSID;
 const char* pass = WIFI_PASSWORD;
@@ -49,14 +52,14 @@ static CHSV colorFromString(String str) {
     return CHSV(h,s,v);
 }
 
-static void setColor(Device* device, String str) {
+static bool setColor(Device* device, String str) {
     CHSV color = colorFromString(str);
-    setHSV(device, color);
+    return postEvent(EVENT_HSV, device->index, 0, color.raw, 3);
 }
 
-static void setDefaultColor(Device* device, String str) {
+static bool setDefaultColor(Device* device, String str) {
     CHSV color = colorFromString(str);
-    writeDefaultColor(device, color);
+    return postEvent(EVENT_DEFAULT, device->index, 0, color.raw, 3);
 }
 
 void process(void (*function) (Device*, uint8_t command)) {
@@ -84,13 +87,26 @@ void process(void (*function) (Device*, uint8_t command)) {
     function(device, command);
 }
 
-static char mess[40];
+static char mess[64];
 
 void get(Device* device, uint8_t command) {
 
     // Execute command
     switch (command) {
         case 'i': deviceInfo(mess, device); break;
+        // Frame statistics of the controller
+        case 'f': {
+            const FrameStats& stats = device->controller->getFrameStats();
+            uint32_t minCycles = (stats.frames == 0) ? 0 : stats.minCycles;
+            sprintf(mess, "%lu %lu %lu %lu %lu", (unsigned long) stats.frames, (unsigned long) stats.retries,
+                (unsigned long) stats.aborts, (unsigned long) (minCycles / clockCyclesPerMicrosecond()),
+                (unsigned long) (stats.maxCycles / clockCyclesPerMicrosecond()));
+            break;
+        }
+        // Number of lost streams
+        case 'l': sprintf(mess, "%lu", (unsigned long) device->streamLosses); break;
+        // Number of UDP packets dropped because the event queue was full
+        case 'q': sprintf(mess, "%lu", (unsigned long) device->droppedPackets); break;
         // Enabled
         case 'e': sprintf(mess, device->enabled ? "1" : "0"); break;
 
@@ -116,7 +132,12 @@ void handleGet() {
     process(get);
 }
 
+/**
+Commands changing the state of a device are posted as events, and are
+executed with the next frame.
+*/
 void set(Device* device, uint8_t command) {
+    bool posted = true;
     // Some command require values
     if (server.hasArg("v")) {
         Serial.println("Has value");
@@ -126,18 +147,18 @@ void set(Device* device, uint8_t command) {
         uint8_t value = strtol(valueString.c_str(), NULL, 16);
         // Execute command
         switch (command) {
-            case 'a': setEnable(device, value); break; // ACTIVATE
+            case 'a': posted = postEvent(EVENT_ENABLE, device->index, 0, &value, 1); break; // ACTIVATE
 
-            case 'h': setParamHSV(device, 0, value); break;
-            case 's': setParamHSV(device, 1, value); break;
-            case 'v': setParamHSV(device, 2, value); break;
+            case 'h': posted = postEvent(EVENT_HSV_PARAM, device->index, 0, &value, 1); break;
+            case 's': posted = postEvent(EVENT_HSV_PARAM, device->index, 1, &value, 1); break;
+            case 'v': posted = postEvent(EVENT_HSV_PARAM, device->index, 2, &value, 1); break;
 
-            case 'c': setColor(device, valueString); break;
-            case 'd': setDefaultColor(device, valueString); break;
+            case 'c': posted = setColor(device, valueString); break;
+            case 'd': posted = setDefaultColor(device, valueString); break;
 
-            case 'r': setParamRGB(device, 0, value); break;
-            case 'g': setParamRGB(device, 1, value); break;
-            case 'b': setParamRGB(device, 2, value); break;
+            case 'r': posted = postEvent(EVENT_RGB_PARAM, device->index, 0, &value, 1); break;
+            case 'g': posted = postEvent(EVENT_RGB_PARAM, device->index, 1, &value, 1); break;
+            case 'b': posted = postEvent(EVENT_RGB_PARAM, device->index, 2, &value, 1); break;
             default:
             server.send(400, "text/plain", "Unknown command");
             return;
@@ -145,15 +166,21 @@ void set(Device* device, uint8_t command) {
     } else {
         Serial.println("No value");
         // Execute commands without values
+        uint8_t value;
         switch (command) {
             // Enabled
-            case 'e': enable(device); break;
-            case 'o': disable(device); break; // OFF
-            case 't': toggle(device); break;
+            case 'e': value = 1; break;
+            case 'o': value = 0; break; // OFF
+            case 't': value = 2; break; // TOGGLE
             default:
             server.send(400, "text/plain", "Unknown command, or no value specified");
             return;
         }
+        posted = postEvent(EVENT_ENABLE, device->index, 0, &value, 1);
+    }
+    if (!posted) {
+        server.send(503, "text/plain", "Too many requests");
+        return;
     }
     server.send(200, "text/plain", "ok");
 }
@@ -164,48 +191,359 @@ void handleSet() {
     process(set);
 }
 
+static char report[512];
+
+/**
+Print the statistics of all tasks, one line per task:
+name, executions, min/mean/max runtime (µs), missed executions, lateness histogram
+*/
+static const char* taskReport() {
+    uint32_t perMicro = clockCyclesPerMicrosecond();
+    size_t length = 0;
+    for (Task* task = Task::getFirst(); task != 0; task = task->getNext()) {
+        const TaskStats& stats = task->getStats();
+        uint32_t mean = (stats.count == 0) ? 0 : stats.totalCycles / stats.count / perMicro;
+        uint32_t min = (stats.count == 0) ? 0 : stats.minCycles / perMicro;
+        length += snprintf(report + length, sizeof(report) - length, "%s %lu %lu %lu %lu %lu",
+            task->getName(), (unsigned long) stats.count, (unsigned long) min, (unsigned long) mean,
+            (unsigned long) (stats.maxCycles / perMicro), (unsigned long) task->getMissed());
+        for (uint8_t i = 0; i < TASK_LATENESS_BINS && length < sizeof(report); i += 1) {
+            length += snprintf(report + length, sizeof(report) - length, " %lu", (unsigned long) stats.lateness[i]);
+        }
+        if (length >= sizeof(report) - 1) {
+            break;
+        }
+        report[length] = '\n';
+        length += 1;
+        report[length] = 0;
+    }
+    return report;
+}
+
+/**
+Information about the whole system, selected by a command:
+'f': Frame interval (ms) and time needed to show all strips (µs)
+'t': Runtime statistics of all tasks
+'o': The number of tasks which couldn't be enabled, because TASKS_MAX tasks were enabled
+'i': Share of the time spent idle (percent)
+'q': Event queue: depth, max depth, dropped, mean and max latency (µs)
+Returns 0 for unknown commands.
+*/
+static const char* systemInfo(uint8_t command) {
+    switch (command) {
+        case 'f':
+        sprintf(mess, "%lu %lu %lu", (unsigned long) getFrameInterval(), (unsigned long) getShowDuration(),
+            (unsigned long) getSkippedFrames());
+        return mess;
+
+        case 't': return taskReport();
+
+        case 'o':
+        sprintf(mess, "%lu", (unsigned long) Task::getOverflows());
+        return mess;
+
+        case 'i':
+        sprintf(mess, "%lu", (unsigned long) (Task::getIdleTime() * 100 / Task::now()));
+        return mess;
+
+        case 'q': {
+            const EventStats& events = getEventStats();
+            uint32_t mean = (events.count == 0) ? 0 : events.totalLatency / events.count;
+            sprintf(mess, "%u %u %lu %lu %lu", events.depth, events.maxDepth,
+                (unsigned long) events.dropped, (unsigned long) mean, (unsigned long) events.maxLatency);
+            return mess;
+        }
+
+        default:  return 0;
+    }
+}
+
+/**
+Handle requests for information about the whole system, selected by '?c='
+*/
+void handleInfo() {
+    uint8_t command = server.hasArg("c") ? server.arg("c").c_str()[0] : 0;
+    const char* info = systemInfo(command);
+    if (info == 0) {
+        server.send(400, "text/plain", "Unknown command");
+        return;
+    }
+    server.send(200, "text/plain", info);
+}
+
+/**
+Handle scene requests: '?s=' selects the scene, '?c=' is either
+'r' (recall, the default) or 'w' (store the current state).
+*/
+void handleScene() {
+    if (!server.hasArg("s")) {
+        server.send(400, "text/plain", "No scene specified, use '?s='");
+        return;
+    }
+    uint8_t id = strtol(server.arg("s").c_str(), NULL, 10);
+    uint8_t command = server.hasArg("c") ? server.arg("c").c_str()[0] : 'r';
+    if (id >= SCENES_MAX) {
+        server.send(400, "text/plain", "Invalid scene specified");
+        return;
+    }
+    bool success;
+    switch (command) {
+        case 'r': success = postEvent(EVENT_SCENE, 0, id); break;
+        case 'w': success = storeScene(id); break;
+        default:
+        server.send(400, "text/plain", "Unknown command");
+        return;
+    }
+    if (!success) {
+        server.send(503, "text/plain", "Busy, try again later");
+        return;
+    }
+    server.send(200, "text/plain", "ok");
+}
+
+/**
+Handle layer requests: '?d=' selects the device, '?l=' the layer,
+'?v=' sets the RGB color (3x 8 bit HEX), '?o=' the opacity (8 bit HEX),
+and '?m=' the blend mode ('a', 'p', 'm' or 's').
+*/
+void handleLayer() {
+    if (!server.hasArg("d") || !server.hasArg("l")) {
+        server.send(400, "text/plain", "No device or layer specified, use '?d=' and '?l='");
+        return;
+    }
+    Device* device = getDeviceById(strtol(server.arg("d").c_str(), NULL, 10));
+    if (device == 0) {
+        server.send(400, "text/plain", "Invalid device specified");
+        return;
+    }
+    uint8_t index = strtol(server.arg("l").c_str(), NULL, 10);
+    Layer* layer = getLayer(device, index);
+    if (layer == 0) {
+        server.send(400, "text/plain", "Invalid layer specified");
+        return;
+    }
+    CRGB color = layer->color;
+    if (server.hasArg("v")) {
+        color = CRGB(strtol(server.arg("v").c_str(), NULL, 16));
+    }
+    uint8_t opacity = layer->opacity;
+    if (server.hasArg("o")) {
+        opacity = strtol(server.arg("o").c_str(), NULL, 16);
+    }
+    uint8_t mode = layer->mode;
+    if (server.hasArg("m")) {
+        mode = server.arg("m").c_str()[0];
+    }
+    uint8_t values[5] = { color.r, color.g, color.b, mode, opacity };
+    if (!postEvent(EVENT_LAYER, device->index, index, values, 5)) {
+        server.send(503, "text/plain", "Too many requests");
+        return;
+    }
+    server.send(200, "text/plain", "ok");
+}
+
+/**
+Handle schedule requests: '?i=' selects the slot, '?c=' is one of
+'r': Read the schedule, as days (hex), hour, minute, action, target
+'w': Write the schedule from '?d=' (days, hex), '?t=' (time, HHMM),
+     '?a=' (action, 's' or 't'), '?v=' (scene or timeline)
+'x': Delete the schedule
+*/
+void handleSchedule() {
+    if (!server.hasArg("i") || !server.hasArg("c")) {
+        server.send(400, "text/plain", "No slot or command specified, use '?i=' and '?c='");
+        return;
+    }
+    uint8_t slot = strtol(server.arg("i").c_str(), NULL, 10);
+    if (slot >= SCHEDULES_MAX) {
+        server.send(400, "text/plain", "Invalid slot specified");
+        return;
+    }
+    Schedule schedule;
+    switch (server.arg("c").c_str()[0]) {
+        case 'r':
+        if (!readSchedule(slot, &schedule)) {
+            server.send(404, "text/plain", "Empty slot");
+            return;
+        }
+        sprintf(mess, "%02x %02d%02d %c %d", schedule.days, schedule.hour,
+            schedule.minute, schedule.action, schedule.target);
+        server.send(200, "text/plain", mess);
+        return;
+
+        case 'w': {
+            if (!server.hasArg("d") || !server.hasArg("t") || !server.hasArg("a") || !server.hasArg("v")) {
+                server.send(400, "text/plain", "Missing parameter, use '?d=', '?t=', '?a=' and '?v='");
+                return;
+            }
+            uint16_t time = strtol(server.arg("t").c_str(), NULL, 10);
+            schedule.days = strtol(server.arg("d").c_str(), NULL, 16);
+            schedule.hour = time / 100;
+            schedule.minute = time % 100;
+            schedule.action = server.arg("a").c_str()[0];
+            schedule.target = strtol(server.arg("v").c_str(), NULL, 10);
+            if (schedule.hour > 23 || schedule.minute > 59) {
+                server.send(400, "text/plain", "Invalid time specified");
+                return;
+            }
+            writeSchedule(slot, schedule);
+            break;
+        }
+
+        case 'x': deleteSchedule(slot); break;
+        default:
+        server.send(400, "text/plain", "Unknown command");
+        return;
+    }
+    server.send(200, "text/plain", "ok");
+}
+
+/**
+Handle timeline requests: '?t=' plays the timeline with the given id,
+'?c=s' stops the current timeline.
+*/
+void handleTimeline() {
+    uint8_t id = TIMELINE_STOP;
+    if (!server.hasArg("c") || server.arg("c").c_str()[0] != 's') {
+        if (!server.hasArg("t")) {
+            server.send(400, "text/plain", "No timeline specified, use '?t='");
+            return;
+        }
+        long value = strtol(server.arg("t").c_str(), NULL, 10);
+        if (value < 0 || value >= getTimelineCount()) {
+            server.send(400, "text/plain", "Invalid timeline specified");
+            return;
+        }
+        id = value;
+    }
+    if (!postEvent(EVENT_TIMELINE, 0, id)) {
+        server.send(503, "text/plain", "Too many requests");
+        return;
+    }
+    server.send(200, "text/plain", "ok");
+}
+
+/**
+Post an event received through UDP. There is no answer to the sender, so
+packets dropped because the queue is full are counted for the device.
+*/
+static void postPacket(Device* device, uint8_t type, uint8_t param = 0, const uint8_t* value = 0, uint8_t length = 0) {
+    if (!postEvent(type, device->index, param, value, length)) {
+        device->droppedPackets += 1;
+    }
+}
+
+/**
+Handle stream packets: (id, type, data...) with type
+'F': Frame, RGB values of the leds starting at the first led
+'K': Keyframe, time stamp in ms (2 bytes, little endian), RGB values of the leds
+*/
+static void receiveStreamPacket(Device* device, uint16_t bytes) {
+    uint8_t type = udp.read();
+    bytes -= 1;
+    switch (type) {
+        case 'F': {
+        CRGB* leds = getStreamBuffer(device);
+        if (leds == 0) { break; }
+        uint16_t length = min(bytes, (uint16_t) (device->leds * 3));
+        udp.read((uint8_t*) leds, length);
+        endStreamFrame(device, length);
+        postPacket(device, EVENT_FRAME);
+        break;
+        }
+
+        case 'K': {
+        if (bytes < 2) { break; }
+        uint8_t stamp[2];
+        udp.read(stamp, 2);
+        bytes -= 2;
+        CRGB* leds = getStreamBuffer(device);
+        if (leds == 0) { break; }
+        uint16_t length = min(bytes, (uint16_t) (device->leds * 3));
+        udp.read((uint8_t*) leds, length);
+        endStreamFrame(device, length);
+        postPacket(device, EVENT_KEYFRAME, 0, stamp, 2);
+        break;
+        }
+
+        default:
+        break;
+    }
+}
+
 /**
 Handle all packets received through UDP. A packet can either contain:
 1 byte: on (>0), off (== 0)
 2 byte: (param, value): 0: hue, 1: saturation, 2: brightness
 3 byte: hue, saturation, brightness
+5+ bytes: a stream packet, see 'receiveStreamPacket()'
 
 Other packets will be ignored
 */
 void receiveUDPPacket() {
-    uint16_t bytes = udp.parsePacket();
+    uint16_t bytes = pendingBytes;
+    pendingBytes = 0;
+    if (bytes == 0) {
+        bytes = udp.parsePacket();
+    }
     if (bytes == 0) {
         return;
     }
+    uint8_t id = udp.read();
+    // System information: (UDP_INFO_ID, command), answered to the sender
+    if (id == UDP_INFO_ID) {
+        const char* info = (bytes == 2) ? systemInfo(udp.read()) : 0;
+        if (info != 0) {
+            udp.beginPacket(udp.remoteIP(), udp.remotePort());
+            udp.write((const uint8_t*) info, strlen(info));
+            udp.endPacket();
+        }
+        udp.flush();
+        return;
+    }
+    // Scene recall: (UDP_SCENE_ID, scene)
+    if (id == UDP_SCENE_ID) {
+        // Not bound to a device, a dropped scene is only counted by the queue
+        if (bytes == 2 && !postEvent(EVENT_SCENE, 0, udp.read())) {
+            Serial.println("Scene dropped");
+        }
+        udp.flush();
+        return;
+    }
     // Get device or cancel request
-    Device* device = getDeviceById(udp.read());
+    Device* device = getDeviceById(id);
     if (device == 0) {
         udp.flush();
         return;
     }
     uint8_t param;
+    uint8_t value;
     CHSV color;
     switch (bytes) {
         case 1:
-        toggle(device);
+        value = 2; // Toggle
+        postPacket(device, EVENT_ENABLE, 0, &value, 1);
         break;
 
         case 2:
-        setEnable(device, udp.read());
+        value = udp.read();
+        postPacket(device, EVENT_ENABLE, 0, &value, 1);
         break;
 
         case 3:
         param = udp.read();
         if (param > 2) { break; }
-        setParamHSV(device, param, udp.read());
+        value = udp.read();
+        postPacket(device, EVENT_HSV_PARAM, param, &value, 1);
         break;
 
         case 4:
         udp.read((char*) &color, 3); // Read the end color
-        setHSV(device, color);
+        postPacket(device, EVENT_HSV, 0, color.raw, 3);
         break;
 
         default:
+        receiveStreamPacket(device, bytes - 1);
         break;
     }
     udp.flush();
@@ -223,11 +561,20 @@ static void handleNotFound() {
  */
 void setup() {
     setupLEDs();
+    setupSchedules();
+#ifdef LIGHT_SLEEP
+    WiFi.setSleepMode(WIFI_LIGHT_SLEEP);
+#endif
     WiFi.begin(ssid, pass);
 
     server.onNotFound(handleNotFound);
     server.on("/get", handleGet);
     server.on("/set", handleSet);
+    server.on("/info", handleInfo);
+    server.on("/scene", handleScene);
+    server.on("/timeline", handleTimeline);
+    server.on("/layer", handleLayer);
+    server.on("/schedule", handleSchedule);
 
     server.begin();
     udp.begin(UDP_DEFAULT_PORT);
@@ -241,8 +588,24 @@ void handleClient() {
 }
 
 /**
-Run the task manager
+Checked between the slices of the sleep, so a UDP packet is handled
+within TASK_SLEEP_SLICE ms instead of waiting for the next poll.
+*/
+static bool packetArrived() {
+    pendingBytes = udp.parsePacket();
+    if (pendingBytes == 0) {
+        return false;
+    }
+    receiveTask.executeIn(0);
+    return true;
+}
+
+/**
+Run the task manager, and sleep until the next task is due.
+UDP packets wake up the loop, while url requests are only polled every
+NETWORK_TIME, and can wait that long.
 */
 void loop() {
     Task::runTasks();
+    Task::waitForNextTask(NETWORK_TIME, packetArrived);
 }
@@ -4,12 +4,33 @@ https://github.com/esp8266/Arduino/blob/master/doc/reference.md
 #include <Arduino.h>
 
 #include "colors.h"
+#include "scenes.h"
+#include "layers.h"
+#include "keyframes.h"
+#include "timeline.h"
+#include "events.h"
+#include "schedules.h"
 #include "customize.h"
 
 #ifndef UDP_DEFAULT_PORT
 #define UDP_DEFAULT_PORT  8000
 #endif
 
+// UDP packets starting with this id recall a scene instead of addressing a device
+#ifndef UDP_SCENE_ID
+#define UDP_SCENE_ID      0xFF
+#endif
+
+// UDP packets starting with this id request system information
+#ifndef UDP_INFO_ID
+#define UDP_INFO_ID       0xFE
+#endif
+
+// Defines the time between checks for new url requests (in ms)
+#ifndef NETWORK_TIME
+#define NETWORK_TIME      100
+#endif
+
 #ifndef SERVER_PORT
 #define SERVER_PORT       80
 #endif
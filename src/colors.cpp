@@ -1,5 +1,9 @@
 
 #include "colors.h"
+#include "layers.h"
+#include "events.h"
+#include "keyframes.h"
+#include "timeline.h"
 
 /* Other libraries */
 #include <SimpleScheduler.h>    /* Simple task scheduling */
@@ -8,16 +12,81 @@
 
 void blendColors();
 
-Task blendTask(blendColors, EX_TIME, false);
+Task blendTask(blendColors, EX_TIME, false, 1, "blend");
+
+void checkStreams();
+
+Task streamTask(checkStreams, STREAM_TIMEOUT / 4, false, 0, "stream");
+
+void refreshFrames();
+
+Task refreshTask(refreshFrames, FRAME_REFRESH_TIME, FRAME_REFRESH_TIME != 0, 0, "refresh");
+
+void writeStorage();
+
+Task storeTask(writeStorage, 0, false, 0, "store");
 
 static Device devices[DEVICES_MAX];
 static uint8_t deviceCount = 0;
 
+/* All controllers used by the devices */
+static CLEDController* controllers[DEVICES_MAX];
+static uint8_t controllerCount = 0;
+
+/* Indicate if the leds of a controller changed, and are shown with the next frame */
+static bool controllerChanged[DEVICES_MAX];
+
+/* The duration of the last update of each controller (in µs) */
+static uint32_t showDuration[DEVICES_MAX];
+
+/* The time between frames, adjusted to the time needed to show all controllers */
+static uint32_t frameInterval = EX_TIME;
+
+/**
+Load the persistent memory into RAM. Only done once, since every call
+to EEPROM.begin() reads the whole block from flash again.
+*/
+void beginStorage() {
+    static bool started = false;
+    if (!started) {
+        EEPROM.begin(EEPROM_SIZE);
+        started = true;
+    }
+}
+
+/**
+ EEPROM.write() only changes the copy in RAM. Writing it to flash blocks for
+ several ms and can't be split, so it is done by a separate task, after the
+ request changing the memory was answered.
+ */
+void writeStorage() {
+    storeTask.disable();
+    EEPROM.commit();
+}
+
+void commitStorage() {
+    storeTask.executeIn(0);
+}
+
+static void registerController(CLEDController* controller) {
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        if (controllers[i] == controller) {
+            return;
+        }
+    }
+    // Converged devices and repeated stream frames don't need to be sent again.
+    // Half the refresh time, so a late refresh isn't taken for a repeated frame.
+    controller->setSkipIdenticalFrames(true, FRAME_REFRESH_TIME / 2);
+    controllers[controllerCount] = controller;
+    controllerCount += 1;
+}
+
 const char* deviceInfo(char* mess, Device* device) {
     sprintf(mess, "%02d: %s RGB: (%03d,%03d,%03d)",
     device->index,
     device->enabled ? "enabled " : "disabled",
     device->endRGB[0], device->endRGB[1], device->endRGB[2]);
+    return mess;
 }
 
 void printDeviceInfo() {
@@ -34,36 +103,75 @@ Set the color to use when when the device is booted up. This will only influence
 the color when the device is set to 'ON' before a different color is set.
 */
 void writeDefaultColor(Device* device, CHSV color) {
-    uint16_t offset = (uint16_t) device->index * 3;
+    uint16_t offset = EEPROM_DEFAULTS_OFFSET + (uint16_t) device->index * 3;
     device->defaultColor = color;
     EEPROM.write(offset,     color.h);
     EEPROM.write(offset + 1, color.s);
     EEPROM.write(offset + 2, color.v);
+    commitStorage();
 }
 
 /**
 Reads the color from EEPROM.
 */
 void readDefaultColor(Device* device) {
-    uint16_t offset = (uint16_t) device->index * 3;
-    EEPROM.begin(offset + 3);
+    uint16_t offset = EEPROM_DEFAULTS_OFFSET + (uint16_t) device->index * 3;
+    beginStorage();
     uint8_t hue = EEPROM.read(offset);
     uint8_t sat = EEPROM.read(offset + 1);
     uint8_t val = EEPROM.read(offset + 2);
     device->defaultColor = CHSV(hue, sat, val);
 }
 
-void addDevice(Device device) {
+void addDevice(CRGB* colors, uint16_t leds, CLEDController* controller) {
     if (deviceCount == DEVICES_MAX) {
         return;
     }
-    device.index = deviceCount;
-    device.controller->showColor(CRGB(0,0,0));
-    device.blending = false;
-    device.enabled = false;
-    readDefaultColor(&device);
-    devices[deviceCount] = device;
+    Device* device = &devices[deviceCount];
+    device->colors = colors;
+    device->leds = leds;
+    device->controller = controller;
+    device->index = deviceCount;
+    registerController(controller);
+    device->endHSV = CHSV(0,0,0);
+    device->endRGB = CRGB(0,0,0);
+    device->currentRGB = CRGB(0,0,0);
+    device->blending = false;
+    device->enabled = false;
+    device->streaming = false;
+    device->fading = false;
+    device->lastFrame = 0;
+    device->streamLosses = 0;
+    device->droppedPackets = 0;
+    device->back = 0;
+    device->backReady = false;
+    readDefaultColor(device);
     deviceCount += 1;
+    showRGB(device, CRGB(0,0,0));
+    showFrame();
+}
+
+void addSegment(CLEDController* controller, uint16_t offset, uint16_t leds) {
+    // A block controller reports the leds of all lanes, which segments may use
+    if ((uint32_t) offset + leds > (uint32_t) controller->size()) {
+        Serial.println("Segment outside of the leds of the controller");
+        return;
+    }
+    addDevice(controller->leds() + offset, leds, controller);
+}
+
+void addLane(CLEDController* controller, uint8_t lane, uint16_t leds) {
+    // A block controller reports the leds of all lanes, the base class only one lane
+    uint16_t length = controller->CLEDController::size();
+    if (leds > length) {
+        Serial.println("Lane too short, increase the length of the controller");
+        leds = length;
+    }
+    addSegment(controller, lane * length, leds);
+}
+
+uint8_t getDeviceCount() {
+    return deviceCount;
 }
 
 Device* getDeviceById(uint8_t id) {
@@ -73,7 +181,17 @@ Device* getDeviceById(uint8_t id) {
     return &devices[id];
 }
 
+void requestFrame() {
+    blendTask.enable();
+}
+
 void startBlend(Device* device) {
+    // Manual changes end a stream or timeline
+    stopTimeline(device);
+    if (device->streaming) {
+        device->streaming = false;
+        device->fading = true;
+    }
     device->blending = true;
     Serial.println("Start blending");
     blendTask.enable(); // Start blending
@@ -148,14 +266,240 @@ void setHSV(Device* device, CHSV color) {
     didSetParam(device);
 }
 
+void setRGB(Device* device, CRGB color) {
+    device->endRGB = color;
+    device->endHSV = rgb2hsv_approximate(color);
+    didSetParam(device);
+}
+
+void markChanged(Device* device) {
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        if (controllers[i] == device->controller) {
+            controllerChanged[i] = true;
+            return;
+        }
+    }
+}
+
+/**
+Send all strips again, even without changes, to recover from noise on the
+data line. Called every FRAME_REFRESH_TIME.
+*/
+void refreshFrames() {
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        controllerChanged[i] = true;
+    }
+    requestFrame();
+}
+
+/**
+Adjust the frame interval, so that showing all controllers (with
+interrupts disabled) takes at most IRQ_OFF_PERCENT of the time.
+*/
+static void updateFrameInterval() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        total += showDuration[i];
+    }
+    uint32_t interval = (total * 100 / IRQ_OFF_PERCENT + 999) / 1000;
+    if (interval < EX_TIME) {
+        interval = EX_TIME;
+    }
+    if (interval != frameInterval) {
+        frameInterval = interval;
+        blendTask.setInterval(interval);
+    }
+}
+
+uint32_t getFrameInterval() {
+    return frameInterval;
+}
+
+uint32_t getShowDuration() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        total += showDuration[i];
+    }
+    return total;
+}
+
+uint32_t getSkippedFrames() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        total += controllers[i]->getSkippedFrames();
+    }
+    return total;
+}
+
+/**
+Show all controllers with changed leds. Segments sharing a controller
+are sent together with a single update of the strip. Controllers which
+can't be shown yet (see CLEDController::isReadyToShow()) stay changed,
+and are shown with the next frame. Returns false in this case.
+*/
+bool showFrame() {
+    bool shown = false;
+    bool waiting = false;
+    for (uint8_t i = 0; i < controllerCount; i += 1) {
+        if (!controllerChanged[i]) {
+            continue;
+        }
+        // Keep the changes for the next frame, if shown too early for the strip
+        if (!controllers[i]->isReadyToShow()) {
+            waiting = true;
+            continue;
+        }
+        uint32_t skipped = controllers[i]->getSkippedFrames();
+        uint32_t start = taskCycles();
+        controllers[i]->showLeds();
+        uint32_t duration = (taskCycles() - start) / clockCyclesPerMicrosecond();
+        controllerChanged[i] = false;
+        // Skipped frames don't tell the time needed to show the leds
+        if (controllers[i]->getSkippedFrames() == skipped) {
+            showDuration[i] = duration;
+            shown = true;
+        }
+    }
+    if (shown) {
+        updateFrameInterval();
+    }
+    if (waiting) {
+        requestFrame();
+    }
+    return !waiting;
+}
+
+/* Set a color on all leds of the device, below any visible layers */
+void showRGB(Device* device, CRGB color) {
+    device->currentRGB = color;
+    if (hasVisibleLayers(device)) {
+        composeLayers(device, color);
+    } else {
+        fill_solid(device->colors, device->leds, color);
+        markChanged(device);
+    }
+}
+
+void setBackBuffer(Device* device, CRGB* buffer) {
+    memcpy((uint8_t*) buffer, (uint8_t*) device->colors, device->leds * sizeof(CRGB));
+    device->back = buffer;
+    device->backReady = false;
+}
+
+CRGB* getStreamBuffer(Device* device) {
+    if (device->back == 0) {
+        return 0;
+    }
+    return device->back;
+}
+
+void endStreamFrame(Device* device, uint16_t bytes) {
+    uint16_t size = device->leds * sizeof(CRGB);
+    if (bytes < size) {
+        // The back buffer still holds an older frame
+        memcpy((uint8_t*) device->back + bytes, (uint8_t*) device->colors + bytes, size - bytes);
+    }
+    device->backReady = true;
+}
+
+bool takeStreamFrame(Device* device, CRGB* leds) {
+    if (!device->backReady) {
+        return false;
+    }
+    memcpy((uint8_t*) leds, (uint8_t*) device->back, device->leds * sizeof(CRGB));
+    device->backReady = false;
+    return true;
+}
+
+/* Show the back buffer, called at the start of a frame */
+static void swapBuffers(Device* device) {
+    if (!device->backReady) {
+        return;
+    }
+    device->backReady = false;
+    CLEDController* controller = device->controller;
+    if (controller->leds() != device->colors || controller->size() != device->leds) {
+        // Segments and lanes share the leds of their controller
+        memcpy((uint8_t*) device->colors, (uint8_t*) device->back, device->leds * sizeof(CRGB));
+        return;
+    }
+    CRGB* front = device->back;
+    device->back = device->colors;
+    device->colors = front;
+    controller->setLeds(front, device->leds);
+}
+
+void showStreamFrame(Device* device) {
+    stopTimeline(device);
+    swapBuffers(device);
+    device->streaming = true;
+    device->fading = false;
+    device->blending = false;
+    device->lastFrame = millis();
+    invalidateLayers(device);
+    markChanged(device);
+    streamTask.enable();
+}
+
+/**
+Fall back to the end color for all devices which didn't receive a frame
+within STREAM_TIMEOUT.
+*/
+void checkStreams() {
+    bool streaming = false;
+    for (uint8_t i = 0; i < deviceCount; i += 1) {
+        Device* device = &devices[i];
+        if (!device->streaming) {
+            continue;
+        }
+        if (millis() - device->lastFrame > STREAM_TIMEOUT) {
+            device->streamLosses += 1;
+            Serial.println("Stream lost");
+            startBlend(device);
+        } else {
+            streaming = true;
+        }
+    }
+    if (!streaming) {
+        streamTask.disable();
+    }
+}
+
+/* Small steps of each led towards the end color */
+static void fadeLeds(Device* device, CRGB end) {
+    bool done = true;
+    for (uint16_t led = 0; led < device->leds; led += 1) {
+        CRGB& current = device->colors[led];
+        for (uint8_t i = 0; i < 3; i++) {
+            if (current[i] != end[i]) {
+                current[i] += (current[i] > end[i]) ? -1 : 1;
+                done = false;
+            }
+        }
+    }
+    invalidateLayers(device);
+    markChanged(device);
+    if (done) {
+        device->fading = false;
+        device->blending = false;
+        device->currentRGB = end;
+        showRGB(device, end);
+    }
+}
+
 /* Small steps towards the end color */
 void blendColor(Device* device) {
     if (!device->blending) {
         return;
     }
 
-    CRGB current = device->currentRGB;
     CRGB end = device->enabled ? device->endRGB : CRGB(0,0,0);
+    if (device->fading) {
+        fadeLeds(device, end);
+        return;
+    }
+
+    CRGB current = device->currentRGB;
 
     // blend rgb, 1 step per channel
     for (uint8_t i = 0; i < 3; i++) {
@@ -163,21 +507,27 @@ void blendColor(Device* device) {
             current[i] += (current[i] > end[i]) ? -1 : 1;
         }
     }
-    device->currentRGB = current;
-    device->controller->showColor(current);
+    showRGB(device, current);
 
     if (current == end) { // Check for end of fade
         device->blending = false;
     }
 }
 
+/**
+Render a frame: Execute the commands received since the last frame,
+make a step towards the end colors, and show the changes.
+*/
 void blendColors() {
+    processEvents();
     bool blending = false;
     for (uint8_t i = 0; i < deviceCount; i += 1) {
         blendColor(&devices[i]);
         blending |= devices[i].blending;
+        blending |= interpolateKeyframes(&devices[i]);
     }
-    if (!blending) {
+    bool shown = showFrame();
+    if (!blending && shown) {
         Serial.println("Stop blending");
         blendTask.disable();
     }
@@ -1,12 +1,12 @@
 #ifndef __COLORS_H
 #define __COLORS_H
 
+// Access user defines (before FastLED, which may be configured there)
+#include "customize.h"
+
 #define FASTLED_ALLOW_INTERRUPTS 0
 #include <FastLED.h>  /* LED strip control https://github.com/FastLED/FastLED */
 
-// Access user defines
-#include "customize.h"
-
 // Defines the maximum number of devices
 #ifndef DEVICES_MAX
 #define DEVICES_MAX       4
@@ -17,10 +17,57 @@
 #define EX_TIME           20
 #endif
 
+// Defines the maximum share of time (in percent) spent showing leds,
+// since interrupts are disabled while sending data to the strips
+#ifndef IRQ_OFF_PERCENT
+#define IRQ_OFF_PERCENT   25
+#endif
+
+// Defines the time between timeline steps (in ms)
+#ifndef TIMELINE_TIME
+#define TIMELINE_TIME     EX_TIME
+#endif
+
+// Defines the maximum number of timelines
+#ifndef TIMELINES_MAX
+#define TIMELINES_MAX     4
+#endif
+
+// Defines the number of layers on top of the color of each device
+#ifndef LAYERS_MAX
+#define LAYERS_MAX        2
+#endif
+
+// Defines the time without frames after which a stream is considered lost (in ms)
+#ifndef STREAM_TIMEOUT
+#define STREAM_TIMEOUT    2000
+#endif
+
+// Defines the time after which all strips are sent again, against noise (in ms, 0: never)
+#ifndef FRAME_REFRESH_TIME
+#define FRAME_REFRESH_TIME 1000
+#endif
+
+// Defines the maximum number of scenes
+#ifndef SCENES_MAX
+#define SCENES_MAX        8
+#endif
+
+// Defines the maximum number of time-of-day schedules
+#ifndef SCHEDULES_MAX
+#define SCHEDULES_MAX     8
+#endif
+
+// Layout of the persistent memory (emulated EEPROM in flash)
+#define EEPROM_DEFAULTS_OFFSET  0
+#define EEPROM_SCENES_OFFSET    (EEPROM_DEFAULTS_OFFSET + DEVICES_MAX * 3)
+#define EEPROM_SCHEDULES_OFFSET (EEPROM_SCENES_OFFSET + SCENES_MAX * DEVICES_MAX * 4)
+#define EEPROM_SIZE             (EEPROM_SCHEDULES_OFFSET + SCHEDULES_MAX * 5)
+
 struct Device {
-    // A pointer to the colors
+    // A pointer to the colors (the first led of the device within the controller)
     CRGB* colors;
-    // The number of leds in the strip
+    // The number of leds of the device
     uint16_t leds;
     // The controller for the leds
     CLEDController* controller;
@@ -38,9 +85,42 @@ struct Device {
     uint8_t index;
     // Indicate if device is currently enabled
     bool enabled;
+    // Indicate if the leds are set by a stream of frames
+    bool streaming;
+    // Indicate if the individual leds fade to the end color (e.g. after a stream)
+    bool fading;
+    // Time when the last frame of the stream was received (in ms)
+    uint32_t lastFrame;
+    // The number of times the stream stopped and the device fell back to its end color
+    uint32_t streamLosses;
+    // The number of UDP packets for the device dropped because the event queue was full
+    uint32_t droppedPackets;
+    // Optional buffer for stream frames, swapped with 'colors' at the next frame
+    CRGB* back;
+    // Indicate if the back buffer contains a new frame
+    bool backReady;
 };
 
-void addDevice(Device device);
+/**
+Add a device for 'leds' leds starting at 'colors', shown by 'controller'.
+The other fields of the device are initialized here.
+*/
+void addDevice(CRGB* colors, uint16_t leds, CLEDController* controller);
+
+/**
+Add a device for a part of the leds of a controller. Several segments can
+share one controller, and are shown together. Segments which don't fit
+into the leds of the controller are not added.
+*/
+void addSegment(CLEDController* controller, uint16_t offset, uint16_t leds);
+
+/**
+Add a device for a lane of a block controller (InlineBlockClocklessController),
+which sends the leds of all lanes at the same time. Lane 0 is on pin 12, lane 1
+on pin 13, and so on. All lanes have the length of the controller, the leds
+after the end of a shorter strip stay dark.
+*/
+void addLane(CLEDController* controller, uint8_t lane, uint16_t leds);
 
 Device* getDeviceById(uint8_t id);
 
@@ -58,8 +138,70 @@ void setParamRGB(Device* device, uint8_t type, uint8_t value);
 
 void setHSV(Device* device, CHSV color);
 
+/* Set the end color in RGB format, the HSV color is approximated */
+void setRGB(Device* device, CRGB color);
+
+void showRGB(Device* device, CRGB color);
+
+/**
+Show the leds of a device, after they were set by a stream. If no frame
+arrives within STREAM_TIMEOUT, the device fades back to its end color.
+*/
+void showStreamFrame(Device* device);
+
+/**
+Give a device a second buffer for its leds, so that stream frames are written
+into the back buffer and shown at the start of the next frame. The buffer needs
+space for the leds of the device. Devices using all leds of their controller
+swap the buffers, segments and lanes copy the frame into their leds.
+*/
+void setBackBuffer(Device* device, CRGB* buffer);
+
+/**
+The buffer to write the next stream frame into, or 0 if the device has no
+back buffer. Streams never write the leds directly, only the render loop does.
+*/
+CRGB* getStreamBuffer(Device* device);
+
+/**
+Complete a frame written into the stream buffer with 'bytes' bytes of RGB values.
+The leds not covered by a short frame keep the color they have now.
+*/
+void endStreamFrame(Device* device, uint16_t bytes);
+
+/**
+Copy a frame waiting in the back buffer into 'leds' instead of showing it,
+e.g. for a keyframe. Returns false if no frame is waiting.
+*/
+bool takeStreamFrame(Device* device, CRGB* leds);
+
+void markChanged(Device* device);
+
+/* Render a frame as soon as possible */
+void requestFrame();
+
+/* Show all changed leds, returns false if a strip can't be shown yet */
+bool showFrame();
+
+/* The time between blending steps (in ms), at least EX_TIME */
+uint32_t getFrameInterval();
+
+/* The time needed to show all controllers (in µs) */
+uint32_t getShowDuration();
+
+/* The number of frames not sent, because they were identical to the last frame */
+uint32_t getSkippedFrames();
+
 void writeDefaultColor(Device* device, CHSV color);
 
+uint8_t getDeviceCount();
+
+/* Load the persistent memory, if not done yet */
+void beginStorage();
+
+/* Write the changed persistent memory to flash, done by a separate task */
+void commitStorage();
+
 void printDeviceInfo();
 
 const char* deviceInfo(char* mess, Device* device);
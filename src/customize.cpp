@@ -12,23 +12,48 @@
 #define BED_NR_OF_LEDS    40
 #define BED_DATA_PIN      14
 
+// Send both strips at the same time as lanes of one block controller (pins 12-14, pin 13 unused)
+// #define PARALLEL_LANES
+
+#ifdef PARALLEL_LANES
+#define LANES             3        // Lanes on pins 12, 13, 14
+#define LANE_NR_OF_LEDS   WALL_NR_OF_LEDS // The length of the longest strip
+
+CRGB lane_colors[LANES * LANE_NR_OF_LEDS]; // Array with colors for the leds of all lanes
+
+// Timing of WS2812B strips (see chipsets.h)
+InlineBlockClocklessController<LANES, PORTA_FIRST_PIN, NS(250), NS(625), NS(375), COLOR_TYPE> lane_controller;
+#else
 CRGB wall_colors[WALL_NR_OF_LEDS]; // Array with colors for the leds
 CRGB bed_colors[BED_NR_OF_LEDS];   // Array with colors for the leds
+#endif
+
+CRGB wall_back[WALL_NR_OF_LEDS]; // Second arrays for streamed frames
+CRGB bed_back[BED_NR_OF_LEDS];
+
+CRGB wall_keyframes[2][WALL_NR_OF_LEDS]; // Keyframes for smooth streams at low rates
+
+// Wake up: ramp the wall to 10% warm white over 20 min, then to 100% over 10 min
+const Keyframe wakeup[] PROGMEM = {
+    { 20UL * 60 * 1000, 0, 20, 180, 25,  EASE_LINEAR },
+    { 30UL * 60 * 1000, 0, 20, 140, 255, EASE_IN_OUT_QUAD },
+};
 
 void setupLEDs() {
+#ifdef PARALLEL_LANES
+    CLEDController &controller = FastLED.addLeds(&lane_controller, lane_colors, LANE_NR_OF_LEDS);
+    addLane(&controller, WALL_DATA_PIN - PORTA_FIRST_PIN, WALL_NR_OF_LEDS);
+    addLane(&controller, BED_DATA_PIN - PORTA_FIRST_PIN, BED_NR_OF_LEDS);
+#else
     CLEDController &wall_controller = FastLED.addLeds<STRIP_TYPE, WALL_DATA_PIN, COLOR_TYPE>(wall_colors, WALL_NR_OF_LEDS);
-    Device wall_device = {
-        wall_colors,
-        WALL_NR_OF_LEDS,
-        &wall_controller
-    };
-    addDevice(wall_device);
-
-    CLEDController &bed_controller = FastLED.addLeds<STRIP_TYPE, BED_DATA_PIN, COLOR_TYPE>(bed_colors, WALL_NR_OF_LEDS);
-    Device bed_device = {
-        bed_colors,
-        BED_NR_OF_LEDS,
-        &bed_controller
-    };
-    addDevice(bed_device);
+    addDevice(wall_colors, WALL_NR_OF_LEDS, &wall_controller);
+
+    CLEDController &bed_controller = FastLED.addLeds<STRIP_TYPE, BED_DATA_PIN, COLOR_TYPE>(bed_colors, BED_NR_OF_LEDS);
+    addDevice(bed_colors, BED_NR_OF_LEDS, &bed_controller);
+#endif
+    setBackBuffer(getDeviceById(0), wall_back);
+    setBackBuffer(getDeviceById(1), bed_back);
+    setKeyframeBuffers(getDeviceById(0), wall_keyframes[0], wall_keyframes[1]);
+
+    addTimeline(wakeup, 2);
 }
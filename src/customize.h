@@ -11,3 +11,33 @@
 
 // Defines the time between blending steps (in ms)
 // #define EX_TIME           20
+
+// Defines the time without stream frames before falling back to the device color (in ms)
+// #define STREAM_TIMEOUT    2000
+
+// Defines the longest time between two stream keyframes which is interpolated (in ms)
+// #define KEYFRAME_GAP_MAX  1000
+
+// Defines the time after which all strips are sent again, against noise (in ms, 0: never)
+// #define FRAME_REFRESH_TIME 1000
+
+// Defines the maximum number of scenes stored in flash
+// #define SCENES_MAX        8
+
+// Defines the maximum share of time (in percent) spent showing leds
+// #define IRQ_OFF_PERCENT   25
+
+// Defines the time between checks for new url requests (in ms)
+// #define NETWORK_TIME      100
+
+// Let the WiFi chip sleep between beacons while idle (saves power, adds latency)
+// #define LIGHT_SLEEP
+
+// Defines the local time zone with its daylight saving rules (POSIX TZ format)
+// #define TIME_ZONE         "CET-1CEST,M3.5.0,M10.5.0/3"
+
+// Defines the maximum number of time-of-day schedules
+// #define SCHEDULES_MAX     8
+
+// Prepare each frame before disabling interrupts (uses 3 bytes of RAM per led)
+// #define FASTLED_ESP8266_PREENCODE
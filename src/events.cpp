@@ -0,0 +1,91 @@
+#include "events.h"
+#include "scenes.h"
+#include "layers.h"
+#include "keyframes.h"
+#include "timeline.h"
+
+static Event queue[EVENTS_MAX];
+
+/* Position of the next event to read and write, wrapping at 256 */
+static uint8_t readIndex = 0;
+static uint8_t writeIndex = 0;
+
+static EventStats stats;
+
+bool postEvent(uint8_t type, uint8_t device, uint8_t param, const uint8_t* value, uint8_t length) {
+    uint8_t depth = writeIndex - readIndex;
+    if (depth == EVENTS_MAX) {
+        stats.dropped += 1;
+        return false;
+    }
+    Event* event = &queue[writeIndex % EVENTS_MAX];
+    event->type = type;
+    event->device = device;
+    event->param = param;
+    memset(event->value, 0, sizeof(event->value));
+    if (value != 0) {
+        memcpy(event->value, value, min(length, (uint8_t) sizeof(event->value)));
+    }
+    event->posted = micros();
+    writeIndex += 1;
+    depth += 1;
+    if (depth > stats.maxDepth) {
+        stats.maxDepth = depth;
+    }
+    requestFrame();
+    return true;
+}
+
+static void executeEvent(Event* event) {
+    if (event->type == EVENT_SCENE) {
+        recallScene(event->param);
+        return;
+    }
+    if (event->type == EVENT_TIMELINE) {
+        if (event->param == TIMELINE_STOP) {
+            stopTimeline();
+        } else {
+            playTimeline(event->param);
+        }
+        return;
+    }
+    Device* device = getDeviceById(event->device);
+    if (device == 0) {
+        return;
+    }
+    switch (event->type) {
+        case EVENT_ENABLE:    setEnable(device, event->value[0]); break;
+        case EVENT_HSV_PARAM: setParamHSV(device, event->param, event->value[0]); break;
+        case EVENT_RGB_PARAM: setParamRGB(device, event->param, event->value[0]); break;
+        case EVENT_HSV:       setHSV(device, CHSV(event->value[0], event->value[1], event->value[2])); break;
+        case EVENT_LAYER:
+        setLayer(device, event->param, CRGB(event->value[0], event->value[1], event->value[2]),
+            event->value[3], event->value[4]);
+        break;
+        case EVENT_FRAME:     showStreamFrame(device); break;
+        case EVENT_KEYFRAME:  showKeyframe(device, event->value[0] | (event->value[1] << 8)); break;
+        case EVENT_DEFAULT:
+        writeDefaultColor(device, CHSV(event->value[0], event->value[1], event->value[2]));
+        break;
+        default: break;
+    }
+}
+
+void processEvents() {
+    while (readIndex != writeIndex) {
+        Event* event = &queue[readIndex % EVENTS_MAX];
+        executeEvent(event);
+        uint32_t latency = micros() - event->posted;
+        stats.count += 1;
+        stats.totalLatency += latency;
+        if (latency > stats.maxLatency) {
+            stats.maxLatency = latency;
+        }
+        readIndex += 1;
+    }
+}
+
+const EventStats& getEventStats() {
+    stats.depth = writeIndex - readIndex;
+    return stats;
+}
@@ -0,0 +1,72 @@
+#ifndef __EVENTS_H
+#define __EVENTS_H
+
+#include "colors.h"
+
+// Defines the capacity of the event queue (power of 2)
+#ifndef EVENTS_MAX
+#define EVENTS_MAX        16
+#endif
+
+/* The commands which can be posted */
+#define EVENT_ENABLE      'a' // value[0]: 0 off, 1 on, other toggle
+#define EVENT_HSV_PARAM   'h' // param: 0 hue, 1 saturation, 2 brightness, value[0]
+#define EVENT_RGB_PARAM   'r' // param: 0 red, 1 green, 2 blue, value[0]
+#define EVENT_HSV         'c' // value[0-2]: hue, saturation, brightness
+#define EVENT_SCENE       'S' // param: the scene (device is ignored)
+#define EVENT_LAYER       'L' // param: the layer, value[0-4]: red, green, blue, mode, opacity
+#define EVENT_FRAME       'F' // The leds of the device were set by a stream
+#define EVENT_KEYFRAME    'K' // value[0-1]: time stamp of the keyframe (little endian)
+#define EVENT_TIMELINE    'T' // param: the timeline, or TIMELINE_STOP (device is ignored)
+#define EVENT_DEFAULT     'D' // value[0-2]: hue, saturation, brightness of the default color
+
+// The timeline of EVENT_TIMELINE which stops the current timeline
+#define TIMELINE_STOP     0xFF
+
+/**
+ A command for a device, posted by the network handlers and executed by
+ the render loop at the start of the next frame.
+ */
+struct Event {
+    // One of the EVENT_* commands
+    uint8_t type;
+    // The index of the device
+    uint8_t device;
+    // Parameter of the command
+    uint8_t param;
+    // Values of the command
+    uint8_t value[5];
+    // Time when the event was posted (micros())
+    uint32_t posted;
+};
+
+/* Statistics of the event queue */
+struct EventStats {
+    // The number of events currently waiting
+    uint8_t depth;
+    // The highest number of waiting events
+    uint8_t maxDepth;
+    // The number of events dropped because the queue was full
+    uint32_t dropped;
+    // The number of executed events
+    uint32_t count;
+    // The sum of the latencies between posting and execution (µs)
+    uint64_t totalLatency;
+    // The highest latency (µs)
+    uint32_t maxLatency;
+};
+
+/**
+ Add an event to the queue, and make sure that the next frame is rendered.
+ Returns false if the queue is full.
+ */
+bool postEvent(uint8_t type, uint8_t device, uint8_t param = 0, const uint8_t* value = 0, uint8_t length = 0);
+
+/**
+ Execute all waiting events. Called by the render loop at frame boundaries.
+ */
+void processEvents();
+
+const EventStats& getEventStats();
+
+#endif
@@ -0,0 +1,74 @@
+#include "keyframes.h"
+#include "layers.h"
+
+/* The keyframes of a single device */
+struct KeyframeBuffer {
+    // The leds shown when the last keyframe arrived
+    CRGB* previous;
+    // The leds of the last keyframe
+    CRGB* next;
+    // Time when the interpolation started (in ms)
+    uint32_t start;
+    // Time between the last two keyframes (in ms)
+    uint16_t duration;
+    // Time stamp of the last keyframe
+    uint16_t stamp;
+    // Indicate if the interpolation is running
+    bool active;
+};
+
+static KeyframeBuffer buffers[DEVICES_MAX];
+
+void setKeyframeBuffers(Device* device, CRGB* previous, CRGB* next) {
+    KeyframeBuffer* buffer = &buffers[device->index];
+    buffer->previous = previous;
+    buffer->next = next;
+    buffer->active = false;
+}
+
+void showKeyframe(Device* device, uint16_t stamp) {
+    KeyframeBuffer* buffer = &buffers[device->index];
+    if (buffer->next == 0) {
+        showStreamFrame(device);
+        return;
+    }
+    if (!takeStreamFrame(device, buffer->next)) {
+        return;
+    }
+    // Continue from the leds currently shown, to avoid jumps
+    memcpy((uint8_t*) buffer->previous, (uint8_t*) device->colors, device->leds * sizeof(CRGB));
+    uint16_t gap = stamp - buffer->stamp;
+    bool following = device->streaming && gap <= KEYFRAME_GAP_MAX;
+    buffer->duration = following ? gap : 0;
+    buffer->stamp = stamp;
+    buffer->start = millis();
+    buffer->active = true;
+    showStreamFrame(device);
+    interpolateKeyframes(device);
+}
+
+bool interpolateKeyframes(Device* device) {
+    KeyframeBuffer* buffer = &buffers[device->index];
+    if (!buffer->active) {
+        return false;
+    }
+    // The stream was lost or replaced by a manual change
+    if (!device->streaming) {
+        buffer->active = false;
+        return false;
+    }
+    uint32_t elapsed = millis() - buffer->start;
+    if (elapsed >= buffer->duration) {
+        memcpy((uint8_t*) device->colors, (uint8_t*) buffer->next, device->leds * sizeof(CRGB));
+        buffer->active = false;
+    } else {
+        fract8 amount = (elapsed * 256) / buffer->duration;
+        for (uint16_t led = 0; led < device->leds; led += 1) {
+            device->colors[led] = buffer->previous[led];
+            nblend(device->colors[led], buffer->next[led], amount);
+        }
+    }
+    invalidateLayers(device);
+    markChanged(device);
+    return buffer->active;
+}
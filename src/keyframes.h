@@ -0,0 +1,32 @@
+#ifndef __KEYFRAMES_H
+#define __KEYFRAMES_H
+
+#include "colors.h"
+
+// Defines the longest time between two keyframes which is interpolated (in ms)
+#ifndef KEYFRAME_GAP_MAX
+#define KEYFRAME_GAP_MAX  1000
+#endif
+
+/**
+ Allow a device to interpolate between streamed keyframes. Both buffers
+ need space for the leds of the device. Keyframes are received into the
+ back buffer like frames (see setBackBuffer()), without keyframe buffers
+ they are shown directly like frames.
+ */
+void setKeyframeBuffers(Device* device, CRGB* previous, CRGB* next);
+
+/**
+ Start the interpolation to the keyframe waiting in the back buffer, with the
+ time stamp of the sender (in ms). The time between two keyframes is taken from the time
+ stamps, so that network delays don't affect the speed of the motion.
+ */
+void showKeyframe(Device* device, uint16_t stamp);
+
+/**
+ Render the current intermediate frame of a device into its leds.
+ Returns true, if further frames are needed to reach the keyframe.
+ */
+bool interpolateKeyframes(Device* device);
+
+#endif
@@ -0,0 +1,105 @@
+#include "layers.h"
+
+/* The layers of a single device */
+struct LayerStack {
+    Layer layers[LAYERS_MAX];
+    // Base color of the last composition
+    CRGB base;
+    // Indicate if the layers changed since the last composition
+    bool changed;
+};
+
+static LayerStack stacks[DEVICES_MAX];
+
+Layer* getLayer(Device* device, uint8_t index) {
+    if (index >= LAYERS_MAX) {
+        return 0;
+    }
+    return &stacks[device->index].layers[index];
+}
+
+bool setLayer(Device* device, uint8_t index, CRGB color, uint8_t mode, uint8_t opacity) {
+    Layer* layer = getLayer(device, index);
+    if (layer == 0) {
+        return false;
+    }
+    layer->pixels = 0;
+    layer->color = color;
+    layer->mode = mode;
+    layer->opacity = opacity;
+    updateLayers(device);
+    return true;
+}
+
+void updateLayers(Device* device) {
+    invalidateLayers(device);
+    showRGB(device, device->currentRGB);
+    requestFrame();
+}
+
+void invalidateLayers(Device* device) {
+    stacks[device->index].changed = true;
+}
+
+bool hasVisibleLayers(Device* device) {
+    LayerStack* stack = &stacks[device->index];
+    for (uint8_t i = 0; i < LAYERS_MAX; i += 1) {
+        if (stack->layers[i].opacity != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Combine a single pixel of a layer with the pixel below */
+static inline void blendPixel(CRGB& pixel, CRGB top, uint8_t mode, uint8_t opacity) {
+    switch (mode) {
+        case LAYER_ADD:
+        pixel += top.nscale8(opacity);
+        return;
+
+        case LAYER_MULTIPLY:
+        nblend(pixel, pixel.scale8(top), opacity);
+        return;
+
+        case LAYER_SCREEN: {
+            CRGB inverse = -pixel;
+            nblend(pixel, -inverse.nscale8(-top), opacity);
+            return;
+        }
+
+        default:
+        nblend(pixel, top, opacity);
+        return;
+    }
+}
+
+static void composeLayer(Device* device, Layer* layer) {
+    CRGB* colors = device->colors;
+    if (layer->pixels == 0) {
+        for (uint16_t i = 0; i < device->leds; i += 1) {
+            blendPixel(colors[i], layer->color, layer->mode, layer->opacity);
+        }
+    } else {
+        for (uint16_t i = 0; i < device->leds; i += 1) {
+            blendPixel(colors[i], layer->pixels[i], layer->mode, layer->opacity);
+        }
+    }
+}
+
+void composeLayers(Device* device, CRGB base) {
+    LayerStack* stack = &stacks[device->index];
+    if (!stack->changed && stack->base == base) {
+        return;
+    }
+    fill_solid(device->colors, device->leds, base);
+    for (uint8_t i = 0; i < LAYERS_MAX; i += 1) {
+        // Transparent layers don't change anything
+        if (stack->layers[i].opacity != 0) {
+            composeLayer(device, &stack->layers[i]);
+        }
+    }
+    stack->base = base;
+    stack->changed = false;
+    markChanged(device);
+}
@@ -0,0 +1,60 @@
+#ifndef __LAYERS_H
+#define __LAYERS_H
+
+#include "colors.h"
+
+/* How a layer is combined with the layers below */
+#define LAYER_ALPHA       'a'
+#define LAYER_ADD         'p'
+#define LAYER_MULTIPLY    'm'
+#define LAYER_SCREEN      's'
+
+/**
+ A layer on top of the base color of a device.
+ */
+struct Layer {
+    // Colors of the individual leds, or 0 to use 'color' for all leds
+    CRGB* pixels;
+    // The color of all leds, if no pixels are set
+    CRGB color;
+    // Opacity of the layer, 0 hides the layer
+    uint8_t opacity;
+    // One of the LAYER_* modes
+    uint8_t mode;
+};
+
+/**
+ Get a layer of a device to modify it. Call 'updateLayers()' after any change.
+ Returns 0 if the index is invalid.
+ */
+Layer* getLayer(Device* device, uint8_t index);
+
+/**
+ Set a layer to a single color and update the leds.
+ Returns false if the index is invalid.
+ */
+bool setLayer(Device* device, uint8_t index, CRGB color, uint8_t mode, uint8_t opacity);
+
+/**
+ Show the changes of the layers of a device with the next frame.
+ */
+void updateLayers(Device* device);
+
+/**
+ Compose the layers again with the next color, after the leds of the device
+ were overwritten by a stream or a fade.
+ */
+void invalidateLayers(Device* device);
+
+/**
+ Returns true, if any layer of the device is visible.
+ */
+bool hasVisibleLayers(Device* device);
+
+/**
+ Combine the base color with all visible layers into the leds of the
+ device, and mark them for the next frame. Does nothing if nothing changed since the last call.
+ */
+void composeLayers(Device* device, CRGB base);
+
+#endif
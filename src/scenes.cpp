@@ -0,0 +1,66 @@
+#include "scenes.h"
+
+#include <EEPROM.h>             // Scenes are stored in the persistent memory
+
+/* Offset of the entry of a device within the scene table */
+static inline uint16_t sceneOffset(uint8_t id, uint8_t device) {
+    return EEPROM_SCENES_OFFSET + (uint16_t) id * SCENE_SIZE + device * SCENE_ENTRY_SIZE;
+}
+
+static SceneEntry readEntry(uint8_t id, uint8_t device) {
+    uint16_t offset = sceneOffset(id, device);
+    SceneEntry entry;
+    entry.color = CRGB(EEPROM.read(offset), EEPROM.read(offset + 1), EEPROM.read(offset + 2));
+    entry.flags = EEPROM.read(offset + 3);
+    return entry;
+}
+
+static void writeEntry(uint8_t id, uint8_t device, SceneEntry entry) {
+    uint16_t offset = sceneOffset(id, device);
+    EEPROM.write(offset,     entry.color.r);
+    EEPROM.write(offset + 1, entry.color.g);
+    EEPROM.write(offset + 2, entry.color.b);
+    EEPROM.write(offset + 3, entry.flags);
+}
+
+bool storeScene(uint8_t id) {
+    if (id >= SCENES_MAX) {
+        return false;
+    }
+    for (uint8_t i = 0; i < DEVICES_MAX; i += 1) {
+        Device* device = getDeviceById(i);
+        SceneEntry entry;
+        if (device == 0) {
+            entry.color = CRGB(0,0,0);
+            entry.flags = SCENE_UNSET;
+        } else {
+            entry.color = device->endRGB;
+            entry.flags = device->enabled ? SCENE_ENABLED : 0;
+        }
+        writeEntry(id, i, entry);
+    }
+    commitStorage();
+    return true;
+}
+
+/**
+ All devices are set up before the blend task runs again,
+ so they crossfade to the scene simultaneously.
+ */
+bool recallScene(uint8_t id) {
+    if (id >= SCENES_MAX) {
+        return false;
+    }
+    for (uint8_t i = 0; i < getDeviceCount(); i += 1) {
+        SceneEntry entry = readEntry(id, i);
+        if (entry.flags == SCENE_UNSET) {
+            continue;
+        }
+        Device* device = getDeviceById(i);
+        setRGB(device, entry.color);
+        if (!(entry.flags & SCENE_ENABLED)) {
+            disable(device);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef __SCENES_H
+#define __SCENES_H
+
+#include "colors.h"
+
+/* Size of the stored state of a single device within a scene */
+#define SCENE_ENTRY_SIZE  4
+
+/* Size of a complete scene */
+#define SCENE_SIZE        (DEVICES_MAX * SCENE_ENTRY_SIZE)
+
+/* Flags of a scene entry */
+#define SCENE_ENABLED     0x01
+#define SCENE_UNSET       0xFF // Erased flash, the device is not part of the scene
+
+/**
+ The stored state of a single device within a scene.
+ */
+struct SceneEntry {
+    // The target color of the device, in RGB format since it can be set either way
+    CRGB color;
+    // Combination of the SCENE_* flags
+    uint8_t flags;
+};
+
+/**
+ Save the current target state of all devices as a scene. The scene is
+ written to flash by a separate task. Returns false if the id is invalid.
+ */
+bool storeScene(uint8_t id);
+
+/**
+ Fade all devices of a scene to their stored state.
+ Returns false if the id is invalid.
+ */
+bool recallScene(uint8_t id);
+
+#endif
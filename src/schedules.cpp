@@ -0,0 +1,184 @@
+#include "schedules.h"
+#include "events.h"
+#include "timeline.h"
+
+#include <EEPROM.h>             // Schedules are stored in the persistent memory
+
+/* Other libraries */
+#include <SimpleScheduler.h>    /* Simple task scheduling */
+
+/* Times before this are not set by NTP yet (2017-01-01) */
+#define TIME_VALID        1483228800
+
+static void checkClock();
+
+Task scheduleTask(checkClock, 1000, true, 0, "schedule");
+
+static Schedule schedules[SCHEDULES_MAX];
+
+/* The next time each schedule fires (UTC in s), 0 if never */
+static time_t nextFire[SCHEDULES_MAX];
+
+/* The slots ordered by the next time they fire, only the first 'activeCount' are used */
+static uint8_t order[SCHEDULES_MAX];
+static uint8_t activeCount = 0;
+
+/* The time of the last check, 0 if the clock is not set */
+static time_t lastCheck = 0;
+
+static inline bool isActive(Schedule* schedule) {
+    return (schedule->action == SCHEDULE_SCENE || schedule->action == SCHEDULE_TIMELINE)
+        && (schedule->days & 0x7F) != 0;
+}
+
+/**
+ The first time after 'now' at which the schedule fires. The days are counted
+ in local time, so the time of day stays the same when daylight saving time
+ starts or ends. A time skipped by the change fires an hour later, a repeated
+ time fires only the first time.
+ */
+static time_t computeNextFire(Schedule* schedule, time_t now) {
+    struct tm today;
+    localtime_r(&now, &today);
+    bool passed = today.tm_hour * 60 + today.tm_min >= schedule->hour * 60 + schedule->minute;
+    for (uint8_t day = passed ? 1 : 0; day < 8; day += 1) {
+        struct tm local = today;
+        local.tm_mday += day;
+        local.tm_hour = schedule->hour;
+        local.tm_min = schedule->minute;
+        local.tm_sec = 0;
+        local.tm_isdst = -1;
+        // Normalises the date and sets the weekday
+        time_t fire = mktime(&local);
+        if ((schedule->days & (1 << local.tm_wday)) && fire > now) {
+            return fire;
+        }
+    }
+    return 0;
+}
+
+/* Insert a slot into the ordered index, keeping the order */
+static void insertOrdered(uint8_t slot) {
+    uint8_t i = activeCount;
+    while (i > 0 && nextFire[order[i - 1]] > nextFire[slot]) {
+        order[i] = order[i - 1];
+        i -= 1;
+    }
+    order[i] = slot;
+    activeCount += 1;
+}
+
+static void removeOrdered(uint8_t slot) {
+    for (uint8_t i = 0; i < activeCount; i += 1) {
+        if (order[i] != slot) {
+            continue;
+        }
+        for (; i + 1 < activeCount; i += 1) {
+            order[i] = order[i + 1];
+        }
+        activeCount -= 1;
+        return;
+    }
+}
+
+static void updateSlot(uint8_t slot, time_t now) {
+    removeOrdered(slot);
+    nextFire[slot] = 0;
+    if (now != 0 && isActive(&schedules[slot])) {
+        nextFire[slot] = computeNextFire(&schedules[slot], now);
+        insertOrdered(slot);
+    }
+}
+
+static void updateAll(time_t now) {
+    activeCount = 0;
+    for (uint8_t i = 0; i < SCHEDULES_MAX; i += 1) {
+        updateSlot(i, now);
+    }
+}
+
+static void storeSlot(uint8_t slot) {
+    uint16_t offset = EEPROM_SCHEDULES_OFFSET + (uint16_t) slot * 5;
+    EEPROM.write(offset,     schedules[slot].days);
+    EEPROM.write(offset + 1, schedules[slot].hour);
+    EEPROM.write(offset + 2, schedules[slot].minute);
+    EEPROM.write(offset + 3, schedules[slot].action);
+    EEPROM.write(offset + 4, schedules[slot].target);
+    commitStorage();
+}
+
+static void fire(Schedule* schedule) {
+    if (schedule->action == SCHEDULE_SCENE) {
+        postEvent(EVENT_SCENE, 0, schedule->target);
+    } else {
+        postEvent(EVENT_TIMELINE, 0, schedule->target);
+    }
+}
+
+void setupSchedules() {
+    beginStorage();
+    for (uint8_t i = 0; i < SCHEDULES_MAX; i += 1) {
+        uint16_t offset = EEPROM_SCHEDULES_OFFSET + (uint16_t) i * 5;
+        schedules[i].days   = EEPROM.read(offset);
+        schedules[i].hour   = EEPROM.read(offset + 1);
+        schedules[i].minute = EEPROM.read(offset + 2);
+        schedules[i].action = EEPROM.read(offset + 3);
+        schedules[i].target = EEPROM.read(offset + 4);
+    }
+    configTime(TIME_ZONE, NTP_SERVER);
+}
+
+static void checkClock() {
+    checkSchedules(time(nullptr));
+}
+
+/**
+ Only the first schedule of the ordered index has to be checked.
+ */
+void checkSchedules(time_t now) {
+    if (now < TIME_VALID) {
+        return;
+    }
+    // The clock was just set, or set back
+    if (now < lastCheck || lastCheck == 0) {
+        updateAll(now);
+    }
+    lastCheck = now;
+    while (activeCount > 0 && nextFire[order[0]] <= now) {
+        uint8_t slot = order[0];
+        fire(&schedules[slot]);
+        if (schedules[slot].days & SCHEDULE_ONCE) {
+            schedules[slot].action = 0;
+            storeSlot(slot);
+        }
+        updateSlot(slot, now);
+    }
+}
+
+bool writeSchedule(uint8_t slot, Schedule schedule) {
+    if (slot >= SCHEDULES_MAX) {
+        return false;
+    }
+    schedules[slot] = schedule;
+    storeSlot(slot);
+    updateSlot(slot, lastCheck);
+    return true;
+}
+
+bool deleteSchedule(uint8_t slot) {
+    if (slot >= SCHEDULES_MAX) {
+        return false;
+    }
+    schedules[slot].action = 0;
+    storeSlot(slot);
+    updateSlot(slot, lastCheck);
+    return true;
+}
+
+bool readSchedule(uint8_t slot, Schedule* schedule) {
+    if (slot >= SCHEDULES_MAX || !isActive(&schedules[slot])) {
+        return false;
+    }
+    *schedule = schedules[slot];
+    return true;
+}
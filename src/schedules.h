@@ -0,0 +1,65 @@
+#ifndef __SCHEDULES_H
+#define __SCHEDULES_H
+
+#include "colors.h"
+
+#include <time.h>
+
+// Defines the local time zone with its daylight saving rules (POSIX TZ format)
+#ifndef TIME_ZONE
+#define TIME_ZONE         "CET-1CEST,M3.5.0,M10.5.0/3"
+#endif
+
+#ifndef NTP_SERVER
+#define NTP_SERVER        "pool.ntp.org"
+#endif
+
+/* The actions of a schedule */
+#define SCHEDULE_SCENE    's' // Recall a scene
+#define SCHEDULE_TIMELINE 't' // Play a timeline
+
+/* Bit of 'days', to remove the schedule after it fired once */
+#define SCHEDULE_ONCE     0x80
+
+/**
+ An action executed at a time of day, stored in flash.
+ */
+struct Schedule {
+    // Days of the week (bit 0: Sunday, ... bit 6: Saturday), and SCHEDULE_ONCE
+    uint8_t days;
+    // Time of the day
+    uint8_t hour;
+    uint8_t minute;
+    // One of the SCHEDULE_* actions, other values mark an empty slot
+    uint8_t action;
+    // The scene or timeline
+    uint8_t target;
+};
+
+/**
+ Load the schedules from flash, and start the clock synchronisation.
+ */
+void setupSchedules();
+
+/**
+ Fire all schedules which are due at 'now' (UTC, as returned by time()).
+ Called every second by the schedule task.
+ */
+void checkSchedules(time_t now);
+
+/**
+ Store a schedule in a slot. Returns false if the slot is invalid.
+ */
+bool writeSchedule(uint8_t slot, Schedule schedule);
+
+/**
+ Remove the schedule in a slot. Returns false if the slot is invalid.
+ */
+bool deleteSchedule(uint8_t slot);
+
+/**
+ Get the schedule in a slot. Returns false if the slot is invalid or empty.
+ */
+bool readSchedule(uint8_t slot, Schedule* schedule);
+
+#endif
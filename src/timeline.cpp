@@ -0,0 +1,173 @@
+#include "timeline.h"
+
+/* Other libraries */
+#include <SimpleScheduler.h>    /* Simple task scheduling */
+
+void timelineStep();
+
+Task timelineTask(timelineStep, TIMELINE_TIME, false, 1, "timeline");
+
+/* The fade of a single device towards its next keyframe */
+struct TimelineSegment {
+    // Color at the start of the segment
+    CRGB from;
+    // Time of the start of the segment (relative to the timeline start)
+    uint32_t start;
+    // Index of the next keyframe of the device, or -1 if done
+    int32_t next;
+};
+
+/* A timeline registered for playback through the api */
+struct TimelineEntry {
+    const Keyframe* frames;
+    uint16_t count;
+};
+
+static TimelineEntry timelines[TIMELINES_MAX];
+static uint8_t timelineCount = 0;
+
+/* The timeline currently playing */
+static const Keyframe* frames = 0;
+static uint16_t frameCount = 0;
+static bool framesInFlash = false;
+static uint32_t startTime;
+
+static TimelineSegment segments[DEVICES_MAX];
+
+static Keyframe loadKeyframe(uint16_t index) {
+    Keyframe frame;
+    if (framesInFlash) {
+        memcpy_P(&frame, &frames[index], sizeof(Keyframe));
+    } else {
+        frame = frames[index];
+    }
+    return frame;
+}
+
+/* Find the next keyframe of a device, starting at index */
+static int32_t nextKeyframe(uint8_t device, uint16_t index) {
+    for (; index < frameCount; index += 1) {
+        if (loadKeyframe(index).device == device) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+static uint8_t ease(uint8_t easing, uint8_t progress) {
+    switch (easing) {
+        case EASE_IN_OUT_QUAD:  return ease8InOutQuad(progress);
+        case EASE_IN_OUT_CUBIC: return ease8InOutCubic(progress);
+        default:                return progress;
+    }
+}
+
+/* Make the target of a keyframe the new state of the device */
+static void reachKeyframe(Device* device, Keyframe& frame) {
+    device->endHSV = CHSV(frame.hue, frame.sat, frame.val);
+    device->endRGB = CRGB(device->endHSV);
+    device->enabled = device->endRGB != CRGB(0,0,0);
+    showRGB(device, device->endRGB);
+}
+
+int8_t addTimeline(const Keyframe* keyframes, uint16_t count) {
+    if (timelineCount == TIMELINES_MAX) {
+        return -1;
+    }
+    timelines[timelineCount].frames = keyframes;
+    timelines[timelineCount].count = count;
+    timelineCount += 1;
+    return timelineCount - 1;
+}
+
+uint8_t getTimelineCount() {
+    return timelineCount;
+}
+
+bool playTimeline(uint8_t id) {
+    if (id >= timelineCount) {
+        return false;
+    }
+    playTimeline(timelines[id].frames, timelines[id].count, true);
+    return true;
+}
+
+void playTimeline(const Keyframe* keyframes, uint16_t count, bool progmem) {
+    frames = keyframes;
+    frameCount = count;
+    framesInFlash = progmem;
+    startTime = millis();
+    for (uint8_t i = 0; i < getDeviceCount(); i += 1) {
+        Device* device = getDeviceById(i);
+        segments[i].from = device->currentRGB;
+        segments[i].start = 0;
+        segments[i].next = nextKeyframe(i, 0);
+        if (segments[i].next >= 0) {
+            // The timeline takes over from the blend engine
+            device->blending = false;
+        }
+    }
+    timelineTask.executeIn(0);
+}
+
+void stopTimeline() {
+    frameCount = 0;
+    timelineTask.disable();
+}
+
+void stopTimeline(Device* device) {
+    // The timeline stops by itself when no device is left
+    segments[device->index].next = -1;
+}
+
+bool isTimelinePlaying() {
+    return timelineTask.isEnabled();
+}
+
+/**
+ All positions are computed from the start time of the timeline,
+ so late or skipped steps do not accumulate drift.
+ */
+void timelineStep() {
+    uint32_t elapsed = millis() - startTime;
+    bool playing = false;
+    for (uint8_t i = 0; i < getDeviceCount(); i += 1) {
+        TimelineSegment* segment = &segments[i];
+        if (segment->next < 0) {
+            continue;
+        }
+        Device* device = getDeviceById(i);
+        Keyframe frame = loadKeyframe(segment->next);
+        // Skip over all keyframes which are already reached
+        while (elapsed >= frame.time) {
+            reachKeyframe(device, frame);
+            segment->from = device->endRGB;
+            segment->start = frame.time;
+            segment->next = nextKeyframe(i, segment->next + 1);
+            if (segment->next < 0) {
+                break;
+            }
+            frame = loadKeyframe(segment->next);
+        }
+        if (segment->next < 0) {
+            continue;
+        }
+        playing = true;
+        uint32_t duration = frame.time - segment->start;
+        uint8_t progress = ((uint64_t) (elapsed - segment->start) * 256) / duration;
+        CRGB color = blend(segment->from, CRGB(CHSV(frame.hue, frame.sat, frame.val)), ease(frame.easing, progress));
+        if (color != device->currentRGB) {
+            showRGB(device, color);
+        }
+    }
+    showFrame();
+    if (!playing) {
+        stopTimeline();
+    } else {
+        // Don't step faster than the strips can be updated
+        uint32_t interval = max((uint32_t) TIMELINE_TIME, getFrameInterval());
+        if (timelineTask.getInterval() != interval) {
+            timelineTask.setInterval(interval);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __TIMELINE_H
+#define __TIMELINE_H
+
+#include "colors.h"
+
+/* The curves used to move towards the target of a keyframe */
+#define EASE_LINEAR       0
+#define EASE_IN_OUT_QUAD  1
+#define EASE_IN_OUT_CUBIC 2
+
+/**
+ A single step of a timeline. The device fades from its previous state
+ (the preceding keyframe of the same device, or the color at the start
+ of the timeline) to the target, which is reached at 'time'.
+ Keyframes must be sorted by time.
+ */
+struct Keyframe {
+    // Milliseconds since the start of the timeline when the target is reached
+    uint32_t time;
+    // Index of the device
+    uint8_t device;
+    // The color to reach (plain bytes, so keyframes can be placed in flash)
+    uint8_t hue;
+    uint8_t sat;
+    uint8_t val;
+    // One of the EASE_* curves
+    uint8_t easing;
+};
+
+/**
+ Register a timeline stored in flash (PROGMEM), to play it through the api.
+ Returns the id of the timeline, or -1 if no space is left.
+ */
+int8_t addTimeline(const Keyframe* frames, uint16_t count);
+
+/**
+ Play a registered timeline. Returns false if the id is invalid.
+ */
+bool playTimeline(uint8_t id);
+
+/* The number of registered timelines, valid ids are below it */
+uint8_t getTimelineCount();
+
+/**
+ Play a list of keyframes, either from RAM or from flash (PROGMEM).
+ The keyframes must stay valid until the timeline ends.
+ */
+void playTimeline(const Keyframe* frames, uint16_t count, bool progmem);
+
+/**
+ Stop the timeline, all devices keep their current color.
+ */
+void stopTimeline();
+
+/**
+ Stop the timeline for a single device, which keeps its current color.
+ Called by all manual changes and streams, so only one of them sets the device.
+ */
+void stopTimeline(Device* device);
+
+bool isTimelinePlaying();
+
+#endif
@@ -0,0 +1,70 @@
+#include <FrameRecorder.h>
+#include <unity.h>
+
+#include <chrono>
+
+static FrameRecorder<4, 4> recorder;
+static CRGB leds[4];
+
+void setUp(void) {
+    recorder.setCorrection(TypicalLEDStrip);
+    recorder.setTemperature(Tungsten40W);
+}
+
+void tearDown(void) {
+}
+
+void test_cached_adjustment_is_exact(void) {
+    for (uint16_t scale = 0; scale < 256; scale += 1) {
+        CRGB expected = CLEDController::computeAdjustment(scale, recorder.getCorrection(), recorder.getTemperature());
+        TEST_ASSERT_TRUE(recorder.getAdjustment(scale) == expected);
+        // Again from the cache
+        TEST_ASSERT_TRUE(recorder.getAdjustment(scale) == expected);
+    }
+    // A new brightness, correction or temperature is used at once
+    recorder.getAdjustment(200);
+    TEST_ASSERT_TRUE(recorder.getAdjustment(100) ==
+        CLEDController::computeAdjustment(100, recorder.getCorrection(), recorder.getTemperature()));
+    recorder.getAdjustment(200);
+    recorder.setCorrection(CRGB(255, 255, 255));
+    TEST_ASSERT_TRUE(recorder.getAdjustment(200) ==
+        CLEDController::computeAdjustment(200, CRGB(255, 255, 255), recorder.getTemperature()));
+    recorder.setTemperature(CRGB(255, 255, 255));
+    TEST_ASSERT_TRUE(recorder.getAdjustment(200) == CRGB(200, 200, 200));
+}
+
+/**
+ The adjustment needed for every frame, at an unchanged brightness: computed
+ each time as before, and taken from the cache. The times depend on the host,
+ so they are only reported.
+ */
+void test_adjustment_benchmark(void) {
+    const uint32_t calls = 5000000;
+    // Read for every call, so the computation can't be moved out of the loop
+    volatile uint8_t brightness = 200;
+    volatile uint8_t sink = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i += 1) {
+        sink += CLEDController::computeAdjustment(brightness, recorder.getCorrection(), recorder.getTemperature()).g;
+    }
+    std::chrono::steady_clock::time_point computed = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i += 1) {
+        sink += recorder.getAdjustment(brightness).g;
+    }
+    std::chrono::steady_clock::time_point cached = std::chrono::steady_clock::now();
+
+    double computeTime = std::chrono::duration<double, std::nano>(computed - start).count() / calls;
+    double cacheTime = std::chrono::duration<double, std::nano>(cached - computed).count() / calls;
+    char message[80];
+    sprintf(message, "%.1f ns per frame computed, %.1f ns from the cache", computeTime, cacheTime);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char **argv) {
+    FastLED.addLeds(&recorder, leds, 4);
+    UNITY_BEGIN();
+    RUN_TEST(test_cached_adjustment_is_exact);
+    RUN_TEST(test_adjustment_benchmark);
+    return UNITY_END();
+}
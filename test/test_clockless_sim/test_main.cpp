@@ -0,0 +1,52 @@
+#include <FastLED.h>
+#include <platforms/esp/8266/clockless_sim_esp8266.h>
+#include <unity.h>
+
+/* All pairs of bits, and the longest runs of equal bits */
+static const uint8_t data[] = { 0x00, 0xFF, 0xA5, 0x5A, 0x0F, 0xF0, 0xCC, 0x33 };
+
+static const ClocklessModel model = ESP8266_CLOCKLESS_MODEL;
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/* The timings of the esp8266 controllers in chipsets.h */
+
+void test_ws2812b(void) {
+    ClocklessTolerance tolerance = WS2812B_TOLERANCE;
+    ClocklessReport report = simulateClockless<NS(250), NS(625), NS(375)>(data, sizeof(data), model);
+    TEST_ASSERT_EQUAL(8 * sizeof(data), report.bits);
+    TEST_ASSERT_TRUE(report.within(tolerance));
+}
+
+void test_sk6812(void) {
+    ClocklessTolerance tolerance = SK6812_TOLERANCE;
+    ClocklessReport report = simulateClockless<NS(300), NS(300), NS(600)>(data, sizeof(data), model);
+    TEST_ASSERT_EQUAL(8 * sizeof(data), report.bits);
+    TEST_ASSERT_TRUE(report.within(tolerance));
+}
+
+void test_ws2811(void) {
+    ClocklessTolerance tolerance = WS2811_TOLERANCE;
+    ClocklessReport report = simulateClockless<NS(320), NS(320), NS(640)>(data, sizeof(data), model);
+    TEST_ASSERT_EQUAL(8 * sizeof(data), report.bits);
+    TEST_ASSERT_TRUE(report.within(tolerance));
+}
+
+void test_too_short_high_time_fails(void) {
+    ClocklessTolerance tolerance = WS2812B_TOLERANCE;
+    ClocklessReport report = simulateClockless<NS(100), NS(775), NS(375)>(data, sizeof(data), model);
+    TEST_ASSERT_FALSE(report.within(tolerance));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ws2812b);
+    RUN_TEST(test_sk6812);
+    RUN_TEST(test_ws2811);
+    RUN_TEST(test_too_short_high_time_fails);
+    return UNITY_END();
+}
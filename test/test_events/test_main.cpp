@@ -0,0 +1,116 @@
+#include <events.h>
+#include <timeline.h>
+#include <FrameRecorder.h>
+#include <SimpleScheduler.h>
+#include <EEPROM.h>
+#include <unity.h>
+
+static FrameRecorder<8, 4> recorder;
+static CRGB leds[8];
+static CRGB back[4];
+
+/* A device using all leds of its controller, which swaps the buffers */
+static FrameRecorder<4, 4> single;
+static CRGB singleLeds[4];
+static CRGB singleBack[4];
+
+/* Stream a frame of 'leds' leds of a color to a device, and show it */
+static void streamFrame(Device* device, uint8_t leds, CRGB color) {
+    fill_solid(getStreamBuffer(device), leds, color);
+    endStreamFrame(device, leds * sizeof(CRGB));
+    TEST_ASSERT_TRUE(postEvent(EVENT_FRAME, device->index));
+    processEvents();
+}
+
+static const Keyframe frames[] = {
+    { 1000, 0, 0, 0, 255, EASE_LINEAR },
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_timeline_starts_at_the_next_frame(void) {
+    int8_t id = addTimeline(frames, 1);
+    TEST_ASSERT_TRUE(id >= 0);
+    TEST_ASSERT_TRUE(postEvent(EVENT_TIMELINE, 0, id));
+    TEST_ASSERT_FALSE(isTimelinePlaying());
+    processEvents();
+    TEST_ASSERT_TRUE(isTimelinePlaying());
+
+    TEST_ASSERT_TRUE(postEvent(EVENT_TIMELINE, 0, TIMELINE_STOP));
+    TEST_ASSERT_TRUE(isTimelinePlaying());
+    processEvents();
+    TEST_ASSERT_FALSE(isTimelinePlaying());
+}
+
+void test_default_color_is_written_by_the_render_loop(void) {
+    Device* device = getDeviceById(0);
+    uint32_t commits = EEPROM.getCommits();
+    uint8_t color[3] = { 10, 20, 30 };
+    TEST_ASSERT_TRUE(postEvent(EVENT_DEFAULT, device->index, 0, color, 3));
+    TEST_ASSERT_EQUAL(commits, EEPROM.getCommits());
+    processEvents();
+    TEST_ASSERT_TRUE(device->defaultColor == CHSV(10, 20, 30));
+    // Written to flash by a task, not by the render loop
+    TEST_ASSERT_EQUAL(commits, EEPROM.getCommits());
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(commits + 1, EEPROM.getCommits());
+}
+
+void test_stream_frames_need_a_back_buffer(void) {
+    Device* first = getDeviceById(0);
+    Device* second = getDeviceById(1);
+    TEST_ASSERT_NULL(getStreamBuffer(first));
+
+    // Segments copy the frame into the leds of the controller
+    setBackBuffer(second, back);
+    CRGB* buffer = getStreamBuffer(second);
+    TEST_ASSERT_EQUAL_PTR(back, buffer);
+    fill_solid(buffer, 4, CRGB(1, 2, 3));
+    endStreamFrame(second, 4 * sizeof(CRGB));
+    TEST_ASSERT_TRUE(postEvent(EVENT_FRAME, second->index));
+    TEST_ASSERT_FALSE(leds[4] == CRGB(1, 2, 3));
+    processEvents();
+    for (uint8_t i = 4; i < 8; i += 1) {
+        TEST_ASSERT_TRUE(leds[i] == CRGB(1, 2, 3));
+    }
+    TEST_ASSERT_EQUAL_PTR(leds, recorder.leds());
+    TEST_ASSERT_EQUAL_PTR(leds + 4, second->colors);
+}
+
+void test_short_frames_keep_the_other_leds(void) {
+    Device* device = getDeviceById(2);
+    streamFrame(device, 4, CRGB(1, 1, 1));
+    streamFrame(device, 4, CRGB(2, 2, 2));
+    // The back buffer now holds the first frame
+    streamFrame(device, 2, CRGB(3, 3, 3));
+    TEST_ASSERT_TRUE(device->colors[1] == CRGB(3, 3, 3));
+    TEST_ASSERT_TRUE(device->colors[2] == CRGB(2, 2, 2));
+    TEST_ASSERT_TRUE(device->colors[3] == CRGB(2, 2, 2));
+
+    // A led cut within its color
+    fill_solid(getStreamBuffer(device), 4, CRGB(4, 4, 4));
+    endStreamFrame(device, 4);
+    TEST_ASSERT_TRUE(postEvent(EVENT_FRAME, device->index));
+    processEvents();
+    TEST_ASSERT_TRUE(device->colors[1] == CRGB(4, 3, 3));
+    TEST_ASSERT_TRUE(device->colors[2] == CRGB(2, 2, 2));
+}
+
+int main(int argc, char **argv) {
+    FastLED.addLeds(&recorder, leds, 8);
+    addSegment(&recorder, 0, 4);
+    addSegment(&recorder, 4, 4);
+    FastLED.addLeds(&single, singleLeds, 4);
+    addDevice(singleLeds, 4, &single);
+    setBackBuffer(getDeviceById(2), singleBack);
+    UNITY_BEGIN();
+    RUN_TEST(test_timeline_starts_at_the_next_frame);
+    RUN_TEST(test_default_color_is_written_by_the_render_loop);
+    RUN_TEST(test_stream_frames_need_a_back_buffer);
+    RUN_TEST(test_short_frames_keep_the_other_leds);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <events.h>
+#include <keyframes.h>
+#include <FrameRecorder.h>
+#include <unity.h>
+
+static FrameRecorder<4, 4> recorder;
+static CRGB leds[4];
+static CRGB back[4];
+static CRGB keyframes[2][4];
+static Device* device;
+
+static const CRGB red = CRGB(255, 0, 0);
+static const CRGB blue = CRGB(0, 0, 255);
+
+/* Receive a keyframe of 'count' leds of a color, like the 'K' packet */
+static void receiveKeyframe(uint8_t count, CRGB color) {
+    fill_solid(getStreamBuffer(device), count, color);
+    endStreamFrame(device, count * sizeof(CRGB));
+}
+
+static void showReceived(uint16_t stamp) {
+    uint8_t value[2] = { (uint8_t) stamp, (uint8_t) (stamp >> 8) };
+    TEST_ASSERT_TRUE(postEvent(EVENT_KEYFRAME, device->index, 0, value, 2));
+    processEvents();
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_received_keyframes_wait_for_the_render_loop(void) {
+    receiveKeyframe(4, red);
+    showReceived(0);
+    TEST_ASSERT_TRUE(leds[0] == red);
+    mockAdvanceMicros(100000);
+    receiveKeyframe(4, blue);
+    showReceived(100);
+    mockAdvanceMicros(50000);
+    interpolateKeyframes(device);
+    CRGB halfway = leds[0];
+    TEST_ASSERT_TRUE(halfway == blend(red, blue, 128));
+
+    // Not posted yet, e.g. because the queue is full: the interpolation goes on
+    receiveKeyframe(4, CRGB(0, 255, 0));
+    interpolateKeyframes(device);
+    TEST_ASSERT_TRUE(leds[0] == halfway);
+    mockAdvanceMicros(50000);
+    interpolateKeyframes(device);
+    TEST_ASSERT_TRUE(leds[3] == blue);
+}
+
+void test_short_keyframes_keep_the_other_leds(void) {
+    receiveKeyframe(4, red);
+    // After a gap, the keyframe is shown at once
+    showReceived(5000);
+    TEST_ASSERT_TRUE(leds[3] == red);
+    mockAdvanceMicros(100000);
+    receiveKeyframe(2, blue);
+    showReceived(5100);
+    mockAdvanceMicros(100000);
+    interpolateKeyframes(device);
+    TEST_ASSERT_TRUE(leds[1] == blue);
+    TEST_ASSERT_TRUE(leds[2] == red);
+    TEST_ASSERT_TRUE(leds[3] == red);
+}
+
+int main(int argc, char **argv) {
+    FastLED.addLeds(&recorder, leds, 4);
+    addDevice(leds, 4, &recorder);
+    device = getDeviceById(0);
+    setBackBuffer(device, back);
+    setKeyframeBuffers(device, keyframes[0], keyframes[1]);
+    UNITY_BEGIN();
+    RUN_TEST(test_received_keyframes_wait_for_the_render_loop);
+    RUN_TEST(test_short_keyframes_keep_the_other_leds);
+    return UNITY_END();
+}
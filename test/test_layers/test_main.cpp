@@ -0,0 +1,46 @@
+#include <layers.h>
+#include <FrameRecorder.h>
+#include <unity.h>
+
+static FrameRecorder<4, 4> recorder;
+static CRGB leds[4];
+static CRGB back[4];
+static Device* device;
+
+static const CRGB red = CRGB(255, 0, 0);
+static const CRGB blue = CRGB(0, 0, 255);
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_compose_after_stream_frame(void) {
+    setLayer(device, 0, blue, LAYER_ALPHA, 128);
+    showRGB(device, red);
+    CRGB composed = leds[0];
+    TEST_ASSERT_TRUE(composed == blend(red, blue, 128));
+
+    // The stream replaces the composition
+    fill_solid(getStreamBuffer(device), 4, CRGB(0, 255, 0));
+    endStreamFrame(device, 4 * sizeof(CRGB));
+    showStreamFrame(device);
+    TEST_ASSERT_TRUE(device->colors[0] == CRGB(0, 255, 0));
+
+    // The same base color has to be composed again
+    showRGB(device, red);
+    for (uint8_t i = 0; i < 4; i += 1) {
+        TEST_ASSERT_TRUE(device->colors[i] == composed);
+    }
+}
+
+int main(int argc, char **argv) {
+    FastLED.addLeds(&recorder, leds, 4);
+    addDevice(leds, 4, &recorder);
+    device = getDeviceById(0);
+    setBackBuffer(device, back);
+    UNITY_BEGIN();
+    RUN_TEST(test_compose_after_stream_frame);
+    return UNITY_END();
+}
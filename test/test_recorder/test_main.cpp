@@ -0,0 +1,173 @@
+#include <FrameRecorder.h>
+#include <unity.h>
+
+/* Collects the bytes written, like a file or the serial port */
+class BufferPrint : public Print {
+public:
+    uint8_t data[512];
+    size_t length = 0;
+
+    virtual size_t write(uint8_t c) {
+        if (length == sizeof(data)) {
+            return 0;
+        }
+        data[length++] = c;
+        return 1;
+    }
+    using Print::write;
+};
+
+static FrameRecorder<4, 3> recorder;
+static CLEDController& controller = recorder;
+static CRGB leds[4];
+
+void setUp(void) {
+    mockSetMicros(0);
+    recorder.setLeds(leds, 4);
+    recorder.setSkipIdenticalFrames(false);
+    recorder.clear();
+    fill_solid(leds, 4, CRGB::Black);
+}
+
+void tearDown(void) {
+}
+
+void test_records_frames(void) {
+    leds[0] = CRGB(1, 2, 3);
+    leds[3] = CRGB(4, 5, 6);
+    mockSetMicros(1234);
+    controller.showLeds(255);
+    TEST_ASSERT_EQUAL(1, recorder.getCount());
+    const FrameRecord& frame = recorder.getFrame(0);
+    TEST_ASSERT_EQUAL(1234, frame.time);
+    TEST_ASSERT_EQUAL(4, frame.leds);
+    TEST_ASSERT_EQUAL(0, frame.flags);
+    TEST_ASSERT_TRUE(frame.scale == CRGB(255, 255, 255));
+    TEST_ASSERT_TRUE(recorder.getPixels(0)[0] == CRGB(1, 2, 3));
+    TEST_ASSERT_TRUE(recorder.getPixels(0)[3] == CRGB(4, 5, 6));
+}
+
+void test_records_solid_frames_and_scale(void) {
+    controller.showColor(CRGB(10, 20, 30), 128);
+    const FrameRecord& frame = recorder.getFrame(0);
+    TEST_ASSERT_EQUAL(FRAME_SOLID, frame.flags);
+    TEST_ASSERT_EQUAL(4, frame.leds);
+    TEST_ASSERT_TRUE(frame.scale == CRGB(128, 128, 128));
+    TEST_ASSERT_TRUE(recorder.getPixels(0)[0] == CRGB(10, 20, 30));
+}
+
+void test_keeps_last_frames(void) {
+    for (uint8_t i = 0; i < 5; i += 1) {
+        leds[0] = CRGB(i, 0, 0);
+        controller.showLeds(255);
+    }
+    TEST_ASSERT_EQUAL(5, recorder.getRecorded());
+    TEST_ASSERT_EQUAL(3, recorder.getCount());
+    TEST_ASSERT_EQUAL(2, recorder.getPixels(0)[0].r);
+    TEST_ASSERT_EQUAL(4, recorder.getPixels(2)[0].r);
+}
+
+void test_skips_identical_frames(void) {
+    recorder.setSkipIdenticalFrames(true);
+    leds[1] = CRGB::Red;
+    controller.showLeds(255);
+    controller.showLeds(255);
+    TEST_ASSERT_EQUAL(1, recorder.getRecorded());
+    controller.showLeds(64);
+    TEST_ASSERT_EQUAL(2, recorder.getRecorded());
+}
+
+/* A recorder for a strip with a maximum refresh rate (frames per second) */
+template<uint16_t RATE> class LimitedRecorder : public FrameRecorder<4, 3> {
+public:
+    virtual uint16_t getMaxRefreshRate() const { return RATE; }
+};
+
+/* Controllers stay in the list of FastLED, so they can't be local */
+static LimitedRecorder<100> limited;
+static LimitedRecorder<400> fastLimited;
+
+void test_skipped_frames_dont_limit_the_rate(void) {
+    CLEDController& limitedController = limited;
+    limited.clear();
+    limited.setLeds(leds, 4);
+    limited.setSkipIdenticalFrames(true);
+    leds[1] = CRGB::Red;
+    limitedController.showLeds(255);
+    TEST_ASSERT_EQUAL(1, limited.getRecorded());
+    mockSetMicros(5000);
+    TEST_ASSERT_FALSE(limitedController.isReadyToShow());
+
+    // Nothing is sent, so the next frame can follow at once
+    mockSetMicros(12000);
+    limitedController.showLeds(255);
+    TEST_ASSERT_EQUAL(1, limited.getRecorded());
+    TEST_ASSERT_TRUE(limitedController.isReadyToShow());
+
+    leds[1] = CRGB::Blue;
+    mockSetMicros(13000);
+    limitedController.showLeds(255);
+    TEST_ASSERT_EQUAL(2, limited.getRecorded());
+    TEST_ASSERT_FALSE(limitedController.isReadyToShow());
+}
+
+void test_clear_waits_for_each_controller(void) {
+    CLEDController& slow = limited;
+    CLEDController& fast = fastLimited;
+    limited.clear();
+    fastLimited.clear();
+    slow.showLeds(255);
+    mockSetMicros(1000);
+    fast.showLeds(255);
+    FastLED.clear(true);
+    // Each controller is cleared once, when its rate allows
+    TEST_ASSERT_EQUAL(2, limited.getRecorded());
+    TEST_ASSERT_EQUAL(2, fastLimited.getRecorded());
+    TEST_ASSERT_TRUE(limited.getFrame(1).time >= 10000);
+    TEST_ASSERT_TRUE(fastLimited.getFrame(1).time >= 3500);
+    TEST_ASSERT_TRUE(limited.getPixels(1)[0] == CRGB(0, 0, 0));
+}
+
+void test_writes_trace(void) {
+    leds[0] = CRGB(1, 2, 3);
+    mockSetMicros(0x01020304);
+    controller.showLeds(255);
+    controller.showColor(CRGB(7, 8, 9), 255);
+    BufferPrint out;
+    size_t bytes = recorder.writeTrace(out);
+    // Magic, then a frame of 4 leds and a solid frame of 1 led
+    TEST_ASSERT_EQUAL(4 + (10 + 4 * 3) + (10 + 3), bytes);
+    TEST_ASSERT_EQUAL(bytes, out.length);
+    TEST_ASSERT_EQUAL_MEMORY(FRAME_TRACE_MAGIC, out.data, 4);
+    const uint8_t header[10] = { 0x04, 0x03, 0x02, 0x01, 4, 0, 0, 255, 255, 255 };
+    TEST_ASSERT_EQUAL_MEMORY(header, out.data + 4, 10);
+    const uint8_t pixel[3] = { 1, 2, 3 };
+    TEST_ASSERT_EQUAL_MEMORY(pixel, out.data + 14, 3);
+    TEST_ASSERT_EQUAL(FRAME_SOLID, out.data[26 + 6]);
+}
+
+void test_writes_ppm(void) {
+    leds[0] = CRGB(200, 100, 50);
+    controller.showLeds(128);
+    BufferPrint out;
+    size_t bytes = recorder.writePPM(out);
+    const char* header = "P6\n4 1\n255\n";
+    TEST_ASSERT_EQUAL(strlen(header) + 4 * 3, bytes);
+    TEST_ASSERT_EQUAL_MEMORY(header, out.data, strlen(header));
+    // The scale is applied to the image
+    const uint8_t pixel[3] = { 100, 50, 25 };
+    TEST_ASSERT_EQUAL_MEMORY(pixel, out.data + strlen(header), 3);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_frames);
+    RUN_TEST(test_records_solid_frames_and_scale);
+    RUN_TEST(test_keeps_last_frames);
+    RUN_TEST(test_skips_identical_frames);
+    RUN_TEST(test_skipped_frames_dont_limit_the_rate);
+    RUN_TEST(test_clear_waits_for_each_controller);
+    RUN_TEST(test_writes_trace);
+    RUN_TEST(test_writes_ppm);
+    return UNITY_END();
+}
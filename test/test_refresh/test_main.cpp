@@ -0,0 +1,53 @@
+#include <colors.h>
+#include <FrameRecorder.h>
+#include <SimpleScheduler.h>
+#include <unity.h>
+
+static FrameRecorder<4, 16> recorder;
+static CRGB leds[4];
+
+/* Run the tasks for a time (in ms) */
+static void run(uint32_t time) {
+    uint32_t start = millis();
+    while (millis() - start < time) {
+        Task::runTasks();
+        mockAdvanceMicros(1000);
+    }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_unchanged_strips_are_refreshed(void) {
+    Device* device = getDeviceById(0);
+    setRGB(device, CRGB(10, 20, 30));
+    // Until the blend is done
+    run(2000);
+    recorder.clear();
+    uint32_t skipped = recorder.getSkippedFrames();
+
+    run(5 * FRAME_REFRESH_TIME + FRAME_REFRESH_TIME / 2);
+    // 5 or 6, depending on the phase of the refresh
+    TEST_ASSERT_TRUE(recorder.getRecorded() >= 5);
+    TEST_ASSERT_TRUE(recorder.getRecorded() <= 6);
+    // The refreshes are sent, not skipped as identical
+    TEST_ASSERT_EQUAL(skipped, recorder.getSkippedFrames());
+    for (uint16_t i = 0; i < recorder.getCount(); i += 1) {
+        TEST_ASSERT_TRUE(recorder.getPixels(i)[0] == CRGB(10, 20, 30));
+        if (i > 0) {
+            uint32_t gap = recorder.getFrame(i).time - recorder.getFrame(i - 1).time;
+            TEST_ASSERT_UINT32_WITHIN(2000, FRAME_REFRESH_TIME * 1000UL, gap);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    FastLED.addLeds(&recorder, leds, 4);
+    addDevice(leds, 4, &recorder);
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_strips_are_refreshed);
+    return UNITY_END();
+}
@@ -0,0 +1,62 @@
+#include <scenes.h>
+#include <FrameRecorder.h>
+#include <SimpleScheduler.h>
+#include <EEPROM.h>
+#include <unity.h>
+
+static FrameRecorder<4, 4> recorder;
+static CRGB leds[8];
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_store_and_recall(void) {
+    FastLED.addLeds(&recorder, leds, 8);
+    addSegment(&recorder, 0, 4);
+    addSegment(&recorder, 4, 4);
+    Device* first = getDeviceById(0);
+    Device* second = getDeviceById(1);
+    setHSV(first, CHSV(100, 200, 150));
+    // Set per channel, the HSV color is not updated
+    setParamRGB(second, 0, 10);
+    setParamRGB(second, 2, 30);
+    uint32_t commits = EEPROM.getCommits();
+    TEST_ASSERT_TRUE(storeScene(1));
+    TEST_ASSERT_FALSE(storeScene(SCENES_MAX));
+    // Written to flash by a task, not by the request
+    TEST_ASSERT_EQUAL(commits, EEPROM.getCommits());
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(commits + 1, EEPROM.getCommits());
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(commits + 1, EEPROM.getCommits());
+
+    CRGB firstColor = first->endRGB;
+    setHSV(first, CHSV(0, 0, 0));
+    setHSV(second, CHSV(0, 0, 255));
+    TEST_ASSERT_TRUE(recallScene(1));
+    TEST_ASSERT_FALSE(recallScene(SCENES_MAX));
+    TEST_ASSERT_TRUE(first->endRGB == firstColor);
+    TEST_ASSERT_TRUE(first->enabled);
+    TEST_ASSERT_TRUE(second->endRGB == CRGB(10, 0, 30));
+    TEST_ASSERT_TRUE(second->enabled);
+    TEST_ASSERT_TRUE(second->blending);
+}
+
+void test_recall_disabled_devices(void) {
+    Device* first = getDeviceById(0);
+    disable(first);
+    TEST_ASSERT_TRUE(storeScene(2));
+    enable(first);
+    TEST_ASSERT_TRUE(recallScene(2));
+    TEST_ASSERT_FALSE(first->enabled);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_store_and_recall);
+    RUN_TEST(test_recall_disabled_devices);
+    return UNITY_END();
+}
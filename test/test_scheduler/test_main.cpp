@@ -0,0 +1,281 @@
+#include <SimpleScheduler.h>
+#include <unity.h>
+
+#include <chrono>
+
+/* The simulated runtime of each task execution (in µs) */
+static uint32_t workTime = 100;
+
+static void work() {
+    mockAdvanceMicros(workTime);
+}
+
+/* The tasks of a test, deleted after the test even if an assertion failed */
+static Task* tasks[TASKS_MAX + 8];
+static uint8_t taskCount = 0;
+
+static Task* add(Task* task) {
+    tasks[taskCount++] = task;
+    return task;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    while (taskCount > 0) {
+        taskCount -= 1;
+        delete tasks[taskCount];
+    }
+}
+
+/**
+ Tasks constructed before the first run, like the static tasks of the
+ firmware, start their interval with it and not at their construction.
+ */
+void test_tasks_start_with_the_first_run(void) {
+    Task* task = add(new Task(work, 10));
+    mockAdvanceMicros(50000);
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(0, task->getStats().count);
+    TEST_ASSERT_EQUAL(0, task->getMissed());
+    mockAdvanceMicros(10000);
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(1, task->getStats().count);
+}
+
+/**
+ Dozens of tasks with different intervals, each running 100 µs. Reports the
+ lateness of the executions on the simulated clock, and the time needed by
+ the host for each dispatch.
+ */
+void test_dispatch_jitter(void) {
+    const uint8_t count = 40;
+    for (uint8_t i = 0; i < count; i += 1) {
+        add(new Task(work, 10 + i, true, 0, "bench"));
+    }
+    uint64_t end = Task::now() + 10000000;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (Task::now() < end) {
+        Task::runTasks();
+        Task::waitForNextTask(100);
+        // The rest of the loop
+        mockAdvanceMicros(20);
+    }
+    double hostTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    uint32_t executions = 0;
+    uint32_t lateness[TASK_LATENESS_BINS] = { 0 };
+    for (uint8_t i = 0; i < count; i += 1) {
+        const TaskStats& stats = tasks[i]->getStats();
+        // No task is starved, each runs once per interval
+        TEST_ASSERT_UINT32_WITHIN(1, 10000 / (10 + i), stats.count);
+        executions += stats.count;
+        for (uint8_t bin = 0; bin < TASK_LATENESS_BINS; bin += 1) {
+            lateness[bin] += stats.lateness[bin];
+        }
+    }
+    char message[160];
+    sprintf(message, "%u executions, lateness < 250 µs: %u, < 500 µs: %u, < 1 ms: %u, < 2 ms: %u, < 4 ms: %u, more: %u",
+        executions, lateness[0], lateness[1], lateness[2], lateness[3], lateness[4],
+        lateness[5] + lateness[6] + lateness[7]);
+    TEST_MESSAGE(message);
+    sprintf(message, "%.0f ns of host time per execution", hostTime / executions);
+    TEST_MESSAGE(message);
+}
+
+void test_too_many_tasks(void) {
+    uint16_t count = 0;
+    // Some tasks may already be enabled
+    while (count <= TASKS_MAX) {
+        if (!add(new Task(work, 10, false))->enable()) {
+            break;
+        }
+        count += 1;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(TASKS_MAX, count);
+    TEST_ASSERT_FALSE(tasks[count]->isEnabled());
+    uint32_t overflows = Task::getOverflows();
+    TEST_ASSERT_FALSE(tasks[count]->executeIn(0));
+    TEST_ASSERT_EQUAL(overflows + 1, Task::getOverflows());
+    // No slot of the pool is used by a task which can't run
+    TEST_ASSERT_NULL(Task::create(work, 10));
+    tasks[0]->disable();
+    Task* created = Task::create(work, 10);
+    TEST_ASSERT_NOT_NULL(created);
+    TEST_ASSERT_TRUE(created->isEnabled());
+    created->release();
+}
+
+static uint32_t skipRuns, catchUpRuns, realignRuns;
+
+static void skip() {
+    skipRuns += 1;
+}
+
+static void catchUp() {
+    catchUpRuns += 1;
+}
+
+static void realign() {
+    realignRuns += 1;
+}
+
+/* Move the simulated time forward, to shortly before micros() overflows */
+static void beforeOverflow(uint32_t margin) {
+    mockSetMicros((((mockMicros() >> 32) + 1) << 32) - margin);
+}
+
+void test_overflow_of_micros(void) {
+    beforeOverflow(50000);
+    uint64_t start = Task::now();
+    Task* task = add(new Task(skip, 10));
+    skipRuns = 0;
+    uint64_t last = start;
+    while (mockMicros() < start + 200000) {
+        Task::runTasks();
+        // The time base keeps counting after the overflow
+        TEST_ASSERT_GREATER_OR_EQUAL(last, Task::now());
+        last = Task::now();
+        mockAdvanceMicros(100);
+    }
+    TEST_ASSERT_EQUAL((uint32_t) (mockMicros() >> 32), (uint32_t) (Task::now() >> 32));
+    TEST_ASSERT_UINT32_WITHIN(1, 20, skipRuns);
+    TEST_ASSERT_EQUAL(0, task->getMissed());
+}
+
+void test_overflow_of_millis(void) {
+    Task* task = add(new Task(skip, 10));
+    skipRuns = 0;
+    // 50 days, millis() overflows after 49.7 days
+    for (uint32_t hour = 0; hour < 50 * 24; hour += 1) {
+        mockAdvanceMicros(3600000000ULL);
+        Task::runTasks();
+    }
+    TEST_ASSERT_EQUAL(50 * 24, skipRuns);
+    skipRuns = 0;
+    for (uint8_t i = 0; i < 100; i += 1) {
+        mockAdvanceMicros(1000);
+        Task::runTasks();
+    }
+    TEST_ASSERT_UINT32_WITHIN(1, 10, skipRuns);
+}
+
+void test_overrun_policies(void) {
+    Task* skipTask = add(new Task(skip, 10));
+    Task* catchUpTask = add(new Task(catchUp, 10));
+    Task* realignTask = add(new Task(realign, 10));
+    catchUpTask->setOverrunPolicy(OVERRUN_CATCH_UP);
+    realignTask->setOverrunPolicy(OVERRUN_REALIGN);
+    skipRuns = catchUpRuns = realignRuns = 0;
+    mockAdvanceMicros(10000);
+    Task::runTasks();
+    // Blocked for 55 ms, the executions at 30, 40, 50 and 60 ms are late
+    mockAdvanceMicros(55000);
+    for (uint8_t i = 0; i < 6; i += 1) {
+        Task::runTasks();
+    }
+    TEST_ASSERT_EQUAL(2, skipRuns);
+    TEST_ASSERT_EQUAL(4, skipTask->getMissed());
+    TEST_ASSERT_EQUAL(6, catchUpRuns);
+    TEST_ASSERT_EQUAL(0, catchUpTask->getMissed());
+    TEST_ASSERT_EQUAL(2, realignRuns);
+    TEST_ASSERT_EQUAL(4, realignTask->getMissed());
+    // Skipping keeps the phase, realigning restarts the interval
+    mockAdvanceMicros(5000);
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(3, skipRuns);
+    TEST_ASSERT_EQUAL(7, catchUpRuns);
+    TEST_ASSERT_EQUAL(2, realignRuns);
+    mockAdvanceMicros(5000);
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(3, realignRuns);
+}
+
+static void slowWork() {
+    mockAdvanceMicros(3000);
+}
+
+void test_lateness_includes_preceding_tasks(void) {
+    Task* first = add(new Task(slowWork, 10, true, 2));
+    Task* second = add(new Task(work, 10, true, 1));
+    mockAdvanceMicros(10000);
+    Task::runTasks();
+    TEST_ASSERT_EQUAL(1, first->getStats().lateness[0]);
+    // Started 3 ms late, after the first task
+    TEST_ASSERT_EQUAL(1, second->getStats().lateness[4]);
+}
+
+static void network() {
+    mockAdvanceMicros(200);
+}
+
+static void render() {
+    mockAdvanceMicros(500);
+}
+
+/* The share of the time (in per mille) not spent waiting in loop(), like api.cpp */
+static uint32_t dutyCycle(uint32_t duration) {
+    uint64_t start = Task::now();
+    uint64_t idle = Task::getIdleTime();
+    while (Task::now() < start + duration) {
+        Task::runTasks();
+        Task::waitForNextTask(100);
+        mockAdvanceMicros(20);
+    }
+    uint64_t busy = Task::now() - start - (Task::getIdleTime() - idle);
+    return busy * 1000 / (Task::now() - start);
+}
+
+void test_idle_duty_cycle(void) {
+    Task* http = add(new Task(network, 100));
+    add(new Task(network, 100));
+    Task* blend = add(new Task(render, 20));
+    uint32_t blending = dutyCycle(2000000);
+    blend->disable();
+    uint32_t idle = dutyCycle(10000000);
+    char message[80];
+    sprintf(message, "CPU busy %u.%u%% while blending, %u.%u%% when idle",
+        blending / 10, blending % 10, idle / 10, idle % 10);
+    TEST_MESSAGE(message);
+    // Busy waiting would keep the CPU at 100 %
+    TEST_ASSERT_LESS_THAN(100, blending);
+    TEST_ASSERT_LESS_THAN(20, idle);
+    // The network tasks still run on time
+    const TaskStats& stats = http->getStats();
+    TEST_ASSERT_UINT32_WITHIN(1, 120, stats.count);
+}
+
+static uint8_t wakeChecks = 0;
+
+static bool wakeAfterThreeChecks() {
+    wakeChecks += 1;
+    return wakeChecks == 3;
+}
+
+void test_wait_ends_when_woken(void) {
+    add(new Task(work, 100));
+    Task::runTasks();
+    uint64_t start = Task::now();
+    // Without a wake check, the whole time until the next task is slept at once
+    Task::waitForNextTask(50);
+    TEST_ASSERT_EQUAL_UINT32(50000, (uint32_t) (Task::now() - start));
+    start = Task::now();
+    Task::waitForNextTask(40, wakeAfterThreeChecks);
+    TEST_ASSERT_EQUAL(3, wakeChecks);
+    TEST_ASSERT_EQUAL_UINT32(3 * TASK_SLEEP_SLICE * 1000, (uint32_t) (Task::now() - start));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tasks_start_with_the_first_run);
+    RUN_TEST(test_dispatch_jitter);
+    RUN_TEST(test_too_many_tasks);
+    RUN_TEST(test_overflow_of_micros);
+    RUN_TEST(test_overflow_of_millis);
+    RUN_TEST(test_overrun_policies);
+    RUN_TEST(test_lateness_includes_preceding_tasks);
+    RUN_TEST(test_idle_duty_cycle);
+    RUN_TEST(test_wait_ends_when_woken);
+    return UNITY_END();
+}
@@ -0,0 +1,102 @@
+#include <schedules.h>
+#include <events.h>
+#include <unity.h>
+
+#define SUNDAY    0x01
+#define MONDAY    0x02
+#define WEDNESDAY 0x08
+#define SATURDAY  0x40
+
+/* Local midnight of a day */
+static time_t localTime(int year, int month, int day) {
+    struct tm local = {};
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_isdst = -1;
+    return mktime(&local);
+}
+
+/* The number of fired schedules (all post an event) */
+static uint32_t fired() {
+    return getEventStats().count + getEventStats().depth;
+}
+
+/**
+ Run the calendar minute by minute, and check every fire against the schedule.
+ The time of day is only checked if it isn't skipped by daylight saving time.
+ Returns the number of fires.
+ */
+static uint32_t simulate(const Schedule& schedule, time_t start, time_t end, bool exact) {
+    uint32_t count = 0;
+    int lastDay = -1;
+    for (time_t now = start; now < end; now += 60) {
+        uint32_t before = fired();
+        checkSchedules(now);
+        processEvents();
+        if (fired() == before) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL(before + 1, fired());
+        struct tm local;
+        localtime_r(&now, &local);
+        if (exact) {
+            TEST_ASSERT_EQUAL(schedule.hour, local.tm_hour);
+            TEST_ASSERT_EQUAL(schedule.minute, local.tm_min);
+        }
+        TEST_ASSERT_TRUE(schedule.days & (1 << local.tm_wday));
+        // Only once per day, also when an hour is repeated
+        TEST_ASSERT_TRUE(local.tm_yday != lastDay);
+        lastDay = local.tm_yday;
+        count += 1;
+    }
+    return count;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    deleteSchedule(0);
+}
+
+void test_time_of_day_follows_daylight_saving(void) {
+    Schedule schedule = { MONDAY | WEDNESDAY | SATURDAY, 7, 30, SCHEDULE_SCENE, 0 };
+    time_t start = localTime(2026, 1, 1);
+    checkSchedules(start);
+    TEST_ASSERT_TRUE(writeSchedule(0, schedule));
+    // 2026 starts on a Thursday: 52 Mondays, 52 Wednesdays, 52 Saturdays
+    TEST_ASSERT_EQUAL(156, simulate(schedule, start, localTime(2027, 1, 1), true));
+}
+
+void test_changed_hours_fire_once(void) {
+    // 2:30 is skipped on 2026-03-29 and repeated on 2026-10-25
+    Schedule schedule = { SUNDAY, 2, 30, SCHEDULE_SCENE, 0 };
+    time_t start = localTime(2026, 3, 28);
+    checkSchedules(start);
+    TEST_ASSERT_TRUE(writeSchedule(0, schedule));
+    TEST_ASSERT_EQUAL(1, simulate(schedule, start, localTime(2026, 3, 30), false));
+
+    start = localTime(2026, 10, 24);
+    checkSchedules(start);
+    TEST_ASSERT_EQUAL(1, simulate(schedule, start, localTime(2026, 10, 26), true));
+}
+
+void test_once_is_removed_after_firing(void) {
+    Schedule schedule = { 0x7F | SCHEDULE_ONCE, 12, 0, SCHEDULE_SCENE, 0 };
+    time_t start = localTime(2026, 6, 1);
+    checkSchedules(start);
+    TEST_ASSERT_TRUE(writeSchedule(0, schedule));
+    TEST_ASSERT_EQUAL(1, simulate(schedule, start, localTime(2026, 6, 8), true));
+    Schedule stored;
+    TEST_ASSERT_FALSE(readSchedule(0, &stored));
+}
+
+int main(int argc, char **argv) {
+    setupSchedules();
+    UNITY_BEGIN();
+    RUN_TEST(test_time_of_day_follows_daylight_saving);
+    RUN_TEST(test_changed_hours_fire_once);
+    RUN_TEST(test_once_is_removed_after_firing);
+    return UNITY_END();
+}
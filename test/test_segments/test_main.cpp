@@ -0,0 +1,41 @@
+#include <colors.h>
+#include <FrameRecorder.h>
+#include <SimpleScheduler.h>
+#include <unity.h>
+
+static FrameRecorder<10, 8> recorder;
+static CRGB leds[10];
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_rejects_segments_outside_of_the_controller(void) {
+    FastLED.addLeds(&recorder, leds, 10);
+    addSegment(&recorder, 0, 4);
+    addSegment(&recorder, 4, 7);
+    addSegment(&recorder, 11, 0);
+    TEST_ASSERT_EQUAL(1, getDeviceCount());
+    addSegment(&recorder, 4, 6);
+    TEST_ASSERT_EQUAL(2, getDeviceCount());
+    TEST_ASSERT_TRUE(getDeviceById(1)->colors == leds + 4);
+}
+
+void test_segments_are_shown_together(void) {
+    recorder.clear();
+    showRGB(getDeviceById(0), CRGB(1, 0, 0));
+    showRGB(getDeviceById(1), CRGB(0, 2, 0));
+    showFrame();
+    TEST_ASSERT_EQUAL(1, recorder.getRecorded());
+    TEST_ASSERT_TRUE(recorder.getPixels(0)[3] == CRGB(1, 0, 0));
+    TEST_ASSERT_TRUE(recorder.getPixels(0)[4] == CRGB(0, 2, 0));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_segments_outside_of_the_controller);
+    RUN_TEST(test_segments_are_shown_together);
+    return UNITY_END();
+}
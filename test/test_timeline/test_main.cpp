@@ -0,0 +1,153 @@
+#include <timeline.h>
+#include <FrameRecorder.h>
+#include <SimpleScheduler.h>
+#include <unity.h>
+
+extern Task timelineTask;
+
+static FrameRecorder<8, 4> recorder;
+static CRGB leds[8];
+static Device* device;
+
+static const CRGB black = CRGB(0, 0, 0);
+static const CRGB white = CRGB(255, 255, 255);
+
+/* Pseudo random steps of the loop, so executions are late by different amounts */
+static uint32_t jitter() {
+    static uint32_t state = 1;
+    state = state * 1103515245 + 12345;
+    return (state >> 16) % 15000;
+}
+
+/* Run the tasks until the time (in ms since the start of the timeline) */
+static void runUntil(uint32_t start, uint32_t time) {
+    while (millis() - start < time) {
+        Task::runTasks();
+        mockAdvanceMicros(5000 + jitter());
+    }
+}
+
+void setUp(void) {
+    if (device == 0) {
+        FastLED.addLeds(&recorder, leds, 8);
+        addDevice(leds, 8, &recorder);
+        device = getDeviceById(0);
+    }
+    stopTimeline();
+    showRGB(device, black);
+}
+
+void tearDown(void) {
+}
+
+void test_positions_follow_the_clock(void) {
+    const Keyframe frames[] = {
+        { 1000, 0, 0, 0, 255, EASE_LINEAR },
+    };
+    playTimeline(frames, 1, false);
+    uint32_t start = millis();
+    uint32_t steps = timelineTask.getStats().count;
+    while (isTimelinePlaying()) {
+        Task::runTasks();
+        if (timelineTask.getStats().count != steps && isTimelinePlaying()) {
+            steps = timelineTask.getStats().count;
+            // Computed from the start, not from the previous step
+            uint8_t progress = (uint32_t) (millis() - start) * 256 / 1000;
+            TEST_ASSERT_TRUE(device->currentRGB == blend(black, white, progress));
+        }
+        mockAdvanceMicros(5000 + jitter());
+    }
+    TEST_ASSERT_GREATER_THAN(20, steps);
+    TEST_ASSERT_TRUE(device->endRGB == white);
+    TEST_ASSERT_TRUE(leds[7] == white);
+}
+
+void test_reaches_keyframes_on_time(void) {
+    // Ramp to 10% warm over 20 minutes, then to 100% over 10 minutes
+    const Keyframe frames[] = {
+        { 20UL * 60 * 1000, 0, 20, 180, 25,  EASE_LINEAR },
+        { 30UL * 60 * 1000, 0, 20, 140, 255, EASE_IN_OUT_QUAD },
+    };
+    const CRGB warm = CHSV(20, 180, 25);
+    playTimeline(frames, 2, false);
+    uint32_t start = millis();
+    runUntil(start, 20UL * 60 * 1000 - 100);
+    TEST_ASSERT_FALSE(device->endRGB == warm);
+    // The steps are at most 20 ms + 20 ms late, so no drift accumulated
+    runUntil(start, 20UL * 60 * 1000 + 40);
+    TEST_ASSERT_TRUE(device->endRGB == warm);
+    runUntil(start, 30UL * 60 * 1000 - 100);
+    TEST_ASSERT_TRUE(isTimelinePlaying());
+    runUntil(start, 30UL * 60 * 1000 + 40);
+    TEST_ASSERT_FALSE(isTimelinePlaying());
+    TEST_ASSERT_TRUE(device->endRGB == CRGB(CHSV(20, 140, 255)));
+}
+
+void test_skips_reached_keyframes(void) {
+    const Keyframe frames[] = {
+        { 100, 0, 0, 0, 50,  EASE_LINEAR },
+        { 200, 0, 0, 0, 100, EASE_IN_OUT_CUBIC },
+        { 300, 0, 0, 0, 150, EASE_LINEAR },
+    };
+    playTimeline(frames, 3, false);
+    Task::runTasks();
+    // A long blocking call passes all keyframes at once
+    mockAdvanceMicros(1000000);
+    Task::runTasks();
+    TEST_ASSERT_FALSE(isTimelinePlaying());
+    TEST_ASSERT_TRUE(device->currentRGB == CRGB(CHSV(0, 0, 150)));
+}
+
+const Keyframe flashFrames[] PROGMEM = {
+    { 500, 0, 0, 0, 255, EASE_IN_OUT_QUAD },
+};
+
+void test_plays_registered_timelines(void) {
+    int8_t id = addTimeline(flashFrames, 1);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, id);
+    TEST_ASSERT_FALSE(playTimeline((uint8_t) TIMELINES_MAX));
+    TEST_ASSERT_TRUE(playTimeline((uint8_t) id));
+    uint32_t start = millis();
+    runUntil(start, 250);
+    TEST_ASSERT_TRUE(device->currentRGB.r > 0 && device->currentRGB.r < 255);
+    runUntil(start, 600);
+    TEST_ASSERT_TRUE(device->currentRGB == white);
+}
+
+void test_stop_keeps_the_color(void) {
+    const Keyframe frames[] = {
+        { 1000, 0, 0, 0, 255, EASE_LINEAR },
+    };
+    playTimeline(frames, 1, false);
+    runUntil(millis(), 500);
+    CRGB color = device->currentRGB;
+    stopTimeline();
+    runUntil(millis(), 1000);
+    TEST_ASSERT_TRUE(device->currentRGB == color);
+}
+
+void test_manual_changes_take_over(void) {
+    const Keyframe frames[] = {
+        { 1000, 0, 0, 0, 255, EASE_LINEAR },
+    };
+    playTimeline(frames, 1, false);
+    runUntil(millis(), 300);
+    setHSV(device, CHSV(0, 0, 40));
+    TEST_ASSERT_TRUE(device->blending);
+    runUntil(millis(), 3000);
+    // The blend engine reached the new color, the timeline didn't set it again
+    TEST_ASSERT_FALSE(isTimelinePlaying());
+    TEST_ASSERT_TRUE(device->currentRGB == CRGB(CHSV(0, 0, 40)));
+    TEST_ASSERT_TRUE(device->endRGB == CRGB(CHSV(0, 0, 40)));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_positions_follow_the_clock);
+    RUN_TEST(test_reaches_keyframes_on_time);
+    RUN_TEST(test_skips_reached_keyframes);
+    RUN_TEST(test_plays_registered_timelines);
+    RUN_TEST(test_stop_keeps_the_color);
+    RUN_TEST(test_manual_changes_take_over);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <FastLED.h>
+#include <platforms/esp/8266/uart_encode_esp8266.h>
+#include <unity.h>
+
+/* Length of a UART period at 3.2 Mbaud (in 0.1ns) */
+#define PERIOD      3125
+
+/* WS2812 timing of chipsets.h: 250ns, 625ns, 375ns (in 0.1ns) */
+#define T0H         2500
+#define T1H         (2500 + 6250)
+#define BIT_TIME    (2500 + 6250 + 3750)
+/* Tolerance of the high times in the WS2812B data sheet */
+#define TOLERANCE   1500
+
+/**
+ The levels of the TX line for the symbols of a byte, one per period: the start
+ bit (high), the inverted data bits (LSB first), and the stop bit (low).
+ */
+static void lineLevels(const uint8_t* symbols, bool* levels) {
+    for (uint8_t s = 0; s < UART_SYMBOLS_PER_BYTE; s += 1) {
+        bool* frame = levels + s * 8;
+        frame[0] = true;
+        for (uint8_t bit = 0; bit < 6; bit += 1) {
+            frame[1 + bit] = !((symbols[s] >> bit) & 1);
+        }
+        frame[7] = false;
+    }
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_bits_match_the_timing(void) {
+    for (uint16_t value = 0; value < 256; value += 1) {
+        uint8_t symbols[UART_SYMBOLS_PER_BYTE];
+        bool levels[UART_SYMBOLS_PER_BYTE * 8];
+        uartEncodeByte(value, symbols);
+        lineLevels(symbols, levels);
+        // 4 periods per WS2812 bit, most significant bit first
+        for (uint8_t bit = 0; bit < 8; bit += 1) {
+            const bool* period = levels + bit * 4;
+            TEST_ASSERT_TRUE(period[0]);
+            uint8_t high = 1;
+            while (high < 4 && period[high]) {
+                high += 1;
+            }
+            // A single pulse, low until the next bit
+            for (uint8_t i = high; i < 4; i += 1) {
+                TEST_ASSERT_FALSE(period[i]);
+            }
+            TEST_ASSERT_TRUE(high < 4);
+            bool one = (value >> (7 - bit)) & 1;
+            int32_t expected = one ? T1H : T0H;
+            TEST_ASSERT_INT_WITHIN(TOLERANCE, expected, high * PERIOD);
+            TEST_ASSERT_INT_WITHIN(TOLERANCE, BIT_TIME, 4 * PERIOD);
+        }
+    }
+}
+
+void test_encode_buffer(void) {
+    const uint8_t data[3] = { 0x00, 0xA5, 0xFF };
+    uint8_t symbols[3 * UART_SYMBOLS_PER_BYTE];
+    uartEncode(data, 3, symbols);
+    for (uint8_t i = 0; i < 3; i += 1) {
+        uint8_t single[UART_SYMBOLS_PER_BYTE];
+        uartEncodeByte(data[i], single);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(single, symbols + i * UART_SYMBOLS_PER_BYTE, UART_SYMBOLS_PER_BYTE);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bits_match_the_timing);
+    RUN_TEST(test_encode_buffer);
+    return UNITY_END();
+}